@@ -3,6 +3,9 @@
 #include <cstddef>  // for size_t, ptrdiff_t
 #include <new>      // for std::bad_alloc, ::operator new, ::operator delete
 #include <stdexcept> // for std::out_of_range
+#ifdef KAD_USE_THREAD_CACHE
+#include "thread_cache.h" // 定义 KAD_USE_THREAD_CACHE 后所有容器的默认分配器改走线程缓存
+#endif
 namespace kad
 {
     template <typename T>
@@ -23,7 +26,11 @@ namespace kad
             {
                 throw std::bad_alloc(); // 如果请求的内存大小太大，则抛出异常
             }
+#ifdef KAD_USE_THREAD_CACHE
+            T* p = static_cast<T*>(thread_cache_allocate(n * sizeof(T))); // 从线程缓存分配
+#else
             T* p = static_cast<T*>(::operator new(n * sizeof(T))); // 调用 ::operator new 分配内存
+#endif
             if (!p)
             {
                 throw std::bad_alloc(); // 如果分配失败，抛出 std::bad_alloc 异常
@@ -34,7 +41,11 @@ namespace kad
         // 释放内存
         void deallocate(T* p, size_type n)
         {
+#ifdef KAD_USE_THREAD_CACHE
+            thread_cache_deallocate(p, n * sizeof(T)); // 还给线程缓存
+#else
             ::operator delete(p, n * sizeof(T)); // 调用 ::operator delete 释放内存
+#endif
         }
 
         // 在已分配内存上构造对象
@@ -43,6 +54,12 @@ namespace kad
             new(p) T(value); // 在 p 指向的内存位置上构造一个 T 对象，使用复制构造函数
         }
 
+        // 移动构造，扩容搬迁元素时使用
+        void construct(T* p, T&& value)
+        {
+            new(p) T(static_cast<T&&>(value));
+        }
+
         // 销毁对象
         void destroy(T* p)
         {
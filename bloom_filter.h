@@ -0,0 +1,186 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "config.h"
+
+namespace kad
+{
+    // 分块计数布隆过滤器：每个键只落在一个 64 字节（一条缓存行）的块里，
+    // 块内 128 个 4 位计数器，因此一次查询只访问一条缓存行；
+    // 计数器支持删除，饱和（15）后不再递减以免产生假阴性
+    class bloom_filter
+    {
+    private:
+        static const size_t counters_per_block = 128;
+        static const size_t counters_per_word = 16;
+        static const size_t num_hashes = 6;
+        static const size_t counters_per_element = 10;
+
+        struct alignas(64) block
+        {
+            uint64_t words[counters_per_block / counters_per_word];
+        };
+
+        std::vector<block> blocks;
+
+        // std::hash 对整数是恒等映射，先混合一次再取位
+        static uint64_t mix(uint64_t h)
+        {
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+        block &block_for(uint64_t m)
+        {
+            return blocks[(m >> 32) % blocks.size()];
+        }
+
+        const block &block_for(uint64_t m) const
+        {
+            return blocks[(m >> 32) % blocks.size()];
+        }
+
+        // 第 i 个计数器在块内的位置：再乘一次后取高位的第 i 个 7 位字段。
+        // 各计数器位置相互独立，实测假阳性率与 estimated_false_positive_rate 的模型一致
+        //（块内双重哈希得到的位置是等差数列，彼此相关，实测比模型高约 40%）
+        static size_t slot(uint64_t m, size_t i)
+        {
+            uint64_t h = m * 0x9e3779b97f4a7c15ULL;
+            return (h >> (64 - 7 * (i + 1))) & (counters_per_block - 1);
+        }
+
+        static unsigned get(const block &b, size_t s)
+        {
+            return (b.words[s / counters_per_word] >> ((s % counters_per_word) * 4)) & 0xF;
+        }
+
+        static void add(block &b, size_t s, int delta)
+        {
+            uint64_t &word = b.words[s / counters_per_word];
+            size_t shift = (s % counters_per_word) * 4;
+            unsigned c = (word >> shift) & 0xF;
+            if (c == 0xF)
+            {
+                return; // 饱和后保持不变
+            }
+            if (delta < 0 && c == 0)
+            {
+                return;
+            }
+            c += delta;
+            word = (word & ~(uint64_t(0xF) << shift)) | (uint64_t(c) << shift);
+        }
+
+    public:
+        bloom_filter() = default;
+
+        // 按预期元素数确定大小
+        explicit bloom_filter(size_t expected_elements)
+        {
+            reset(expected_elements);
+        }
+
+        void reset(size_t expected_elements)
+        {
+            size_t n = expected_elements ? expected_elements : 1;
+            size_t num_blocks = (n * counters_per_element + counters_per_block - 1) / counters_per_block;
+            blocks.assign(num_blocks, block());
+        }
+
+        void clear()
+        {
+            blocks.clear();
+        }
+
+        bool enabled() const
+        {
+            return !blocks.empty();
+        }
+
+        // 参数为键的完整哈希值
+        void insert(size_t hash)
+        {
+            uint64_t m = mix(hash);
+            block &b = block_for(m);
+            for (size_t i = 0; i < num_hashes; ++i)
+            {
+                add(b, slot(m, i), 1);
+            }
+        }
+
+        void erase(size_t hash)
+        {
+            uint64_t m = mix(hash);
+            block &b = block_for(m);
+            for (size_t i = 0; i < num_hashes; ++i)
+            {
+                add(b, slot(m, i), -1);
+            }
+        }
+
+        // 预取 hash 所在的块，供批量查询在调用 may_contain 之前使缓存缺失重叠；未启用时什么都不做
+        void prefetch(size_t hash) const
+        {
+            if (enabled())
+            {
+                KAD_PREFETCH(&block_for(mix(hash)));
+            }
+        }
+
+        // 返回 false 表示一定不存在
+        bool may_contain(size_t hash) const
+        {
+            uint64_t m = mix(hash);
+            const block &b = block_for(m);
+            for (size_t i = 0; i < num_hashes; ++i)
+            {
+                if (get(b, slot(m, i)) == 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // 估算的假阳性率。查询随机落在某一块，所以逐块计算 fill^num_hashes 再取平均；
+        // 块间负载不均，按整体填充率计算会低估约一半
+        double estimated_false_positive_rate() const
+        {
+            if (blocks.empty())
+            {
+                return 1.0;
+            }
+            double total = 0.0;
+            for (const block &b : blocks)
+            {
+                size_t nonzero = 0;
+                for (size_t s = 0; s < counters_per_block; ++s)
+                {
+                    nonzero += get(b, s) != 0;
+                }
+                double fill = static_cast<double>(nonzero) / counters_per_block;
+                double p = 1.0;
+                for (size_t i = 0; i < num_hashes; ++i)
+                {
+                    p *= fill;
+                }
+                total += p;
+            }
+            return total / blocks.size();
+        }
+
+        size_t memory_bytes() const
+        {
+            return blocks.size() * sizeof(block);
+        }
+    };
+}
+
+#endif // BLOOM_FILTER_H
@@ -0,0 +1,379 @@
+#ifndef CONCURRENT_SKIPLIST_MAP_H
+#define CONCURRENT_SKIPLIST_MAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include "epoch.h"
+
+namespace kad
+{
+    // 无锁有序跳表映射。
+    // - insert / find 无锁；erase 先逐层给节点的 next 指针打删除标记（逻辑删除），
+    //   再由查找过程把带标记的节点从各层摘下（物理删除）；
+    // - 摘下的节点通过 epoch_retire 延迟释放，所以遍历中读到的节点不会被提前释放；
+    // - for_each / for_each_range 在并发修改时也是安全的，只访问未被删除的节点。
+    // 键不可修改；值在插入后不会被库修改，插入已存在的键返回 false。
+    template <typename K, typename V>
+    class concurrent_skiplist_map
+    {
+    private:
+        static const int max_level = 24;
+
+        // 节点状态位：插入方是否已完成所有层的链接、删除方是否已完成摘除。
+        // 两者都完成后由后完成的一方退休节点，避免节点在仍被链接时被释放
+        static const int insert_done = 1;
+        static const int remove_done = 2;
+
+        struct node
+        {
+            K key;
+            V value;
+            int levels;
+            std::atomic<int> state;
+            std::atomic<uintptr_t> *next; // levels 个指针，最低位为删除标记
+
+            node(const K &k, const V &v, int l, std::atomic<uintptr_t> *links)
+                : key(k), value(v), levels(l), state(0), next(links)
+            {
+                for (int i = 0; i < l; ++i)
+                {
+                    new (&next[i]) std::atomic<uintptr_t>(0);
+                }
+            }
+        };
+
+        std::atomic<uintptr_t> head_[max_level];
+        std::atomic<size_t> size_;
+
+        static node *ptr(uintptr_t p) { return reinterpret_cast<node *>(p & ~uintptr_t(1)); }
+        static bool marked(uintptr_t p) { return p & 1; }
+        static uintptr_t pack(node *n, bool mark = false) { return reinterpret_cast<uintptr_t>(n) | uintptr_t(mark); }
+
+        // 节点和它的 next 数组放在同一块内存里
+        static node *create_node(const K &key, const V &value, int levels)
+        {
+            size_t links_offset = (sizeof(node) + alignof(std::atomic<uintptr_t>) - 1) /
+                                  alignof(std::atomic<uintptr_t>) * alignof(std::atomic<uintptr_t>);
+            char *block = static_cast<char *>(
+                ::operator new(links_offset + levels * sizeof(std::atomic<uintptr_t>)));
+            std::atomic<uintptr_t> *links = reinterpret_cast<std::atomic<uintptr_t> *>(block + links_offset);
+            return new (block) node(key, value, levels, links);
+        }
+
+        static void destroy_node(void *p)
+        {
+            node *n = static_cast<node *>(p);
+            n->~node();
+            ::operator delete(p);
+        }
+
+        static void retire(node *n)
+        {
+            epoch_retire(n, &concurrent_skiplist_map::destroy_node);
+        }
+
+        // 给已完成的一方打标记，另一方也已完成时退休节点
+        static void finish(node *n, int flag)
+        {
+            if (n->state.fetch_or(flag) == (insert_done | remove_done) - flag)
+            {
+                retire(n);
+            }
+        }
+
+        std::atomic<uintptr_t> &next_of(node *pred, int level)
+        {
+            return pred ? pred->next[level] : head_[level];
+        }
+
+        static bool less(const K &a, const K &b) { return a < b; }
+
+        // 几何分布的随机层数，p = 1/2
+        static int random_level()
+        {
+            static thread_local uint64_t seed = reinterpret_cast<uintptr_t>(&seed) * 0x9e3779b97f4a7c15ULL | 1;
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            int level = 1;
+            uint64_t bits = seed;
+            while ((bits & 1) && level < max_level)
+            {
+                ++level;
+                bits >>= 1;
+            }
+            return level;
+        }
+
+        // 找到每层中 key 的前驱和后继，顺带摘下途中遇到的带删除标记的节点。
+        // 前驱为空表示表头
+        bool locate(const K &key, node **preds, node **succs)
+        {
+        retry:
+            node *pred = nullptr;
+            for (int level = max_level - 1; level >= 0; --level)
+            {
+                node *curr = ptr(next_of(pred, level).load());
+                while (curr)
+                {
+                    uintptr_t succ = curr->next[level].load();
+                    while (marked(succ))
+                    {
+                        // curr 已被逻辑删除，从这一层摘下
+                        uintptr_t expected = pack(curr);
+                        if (!next_of(pred, level).compare_exchange_strong(expected, pack(ptr(succ))))
+                        {
+                            goto retry;
+                        }
+                        curr = ptr(succ);
+                        if (!curr)
+                        {
+                            break;
+                        }
+                        succ = curr->next[level].load();
+                    }
+                    if (curr && less(curr->key, key))
+                    {
+                        pred = curr;
+                        curr = ptr(succ);
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+                preds[level] = pred;
+                succs[level] = curr;
+            }
+            return succs[0] && !less(key, succs[0]->key);
+        }
+
+        // 第一个键不小于 key 且未被删除的节点，不修改结构
+        node *lower_bound_node(const K &key)
+        {
+            node *pred = nullptr;
+            node *curr = nullptr;
+            for (int level = max_level - 1; level >= 0; --level)
+            {
+                curr = ptr(next_of(pred, level).load());
+                while (curr)
+                {
+                    uintptr_t succ = curr->next[level].load();
+                    if (!marked(succ) && !less(curr->key, key))
+                    {
+                        break;
+                    }
+                    if (!marked(succ))
+                    {
+                        pred = curr;
+                    }
+                    curr = ptr(succ);
+                }
+            }
+            return curr;
+        }
+
+    public:
+        concurrent_skiplist_map() : size_(0)
+        {
+            for (int i = 0; i < max_level; ++i)
+            {
+                head_[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        // 析构时不能有其它线程在访问
+        ~concurrent_skiplist_map()
+        {
+            node *curr = ptr(head_[0].load());
+            while (curr)
+            {
+                node *next = ptr(curr->next[0].load());
+                destroy_node(curr);
+                curr = next;
+            }
+        }
+
+        concurrent_skiplist_map(const concurrent_skiplist_map &) = delete;
+        concurrent_skiplist_map &operator=(const concurrent_skiplist_map &) = delete;
+
+        // 插入键值对，键已存在时返回 false
+        bool insert(const K &key, const V &value)
+        {
+            epoch_guard guard;
+            node *preds[max_level];
+            node *succs[max_level];
+            int levels = random_level();
+            node *fresh = nullptr;
+
+            while (true)
+            {
+                if (locate(key, preds, succs))
+                {
+                    if (fresh)
+                    {
+                        destroy_node(fresh); // 尚未发布，可以直接释放
+                    }
+                    return false;
+                }
+                if (!fresh)
+                {
+                    fresh = create_node(key, value, levels);
+                }
+                for (int level = 0; level < levels; ++level)
+                {
+                    fresh->next[level].store(pack(succs[level]));
+                }
+                // 链接到最底层即插入成功
+                uintptr_t expected = pack(succs[0]);
+                if (next_of(preds[0], 0).compare_exchange_strong(expected, pack(fresh)))
+                {
+                    break;
+                }
+            }
+            size_.fetch_add(1);
+
+            // 逐层向上链接；节点已被删除时停止
+            for (int level = 1; level < levels; ++level)
+            {
+                bool stop = false;
+                while (true)
+                {
+                    uintptr_t own = fresh->next[level].load();
+                    if (marked(own))
+                    {
+                        stop = true;
+                        break;
+                    }
+                    if (ptr(own) != succs[level] &&
+                        !fresh->next[level].compare_exchange_strong(own, pack(succs[level])))
+                    {
+                        continue;
+                    }
+                    uintptr_t expected = pack(succs[level]);
+                    if (next_of(preds[level], level).compare_exchange_strong(expected, pack(fresh)))
+                    {
+                        break;
+                    }
+                    // 前驱已变化，重新定位；节点已不在最底层说明它已被删除
+                    if (!locate(key, preds, succs) || succs[0] != fresh)
+                    {
+                        stop = true;
+                        break;
+                    }
+                }
+                if (stop)
+                {
+                    break;
+                }
+            }
+
+            // 链接过程中节点被删除：再查找一次，确保它从所有层摘下
+            if (marked(fresh->next[0].load()))
+            {
+                locate(key, preds, succs);
+            }
+            finish(fresh, insert_done);
+            return true;
+        }
+
+        // 查找键，找到时把值拷贝到 out
+        bool find(const K &key, V &out)
+        {
+            epoch_guard guard;
+            node *n = lower_bound_node(key);
+            if (!n || less(key, n->key))
+            {
+                return false;
+            }
+            out = n->value;
+            return true;
+        }
+
+        bool contains(const K &key)
+        {
+            epoch_guard guard;
+            node *n = lower_bound_node(key);
+            return n && !less(key, n->key);
+        }
+
+        // 删除键，返回是否由本次调用删除
+        bool erase(const K &key)
+        {
+            epoch_guard guard;
+            node *preds[max_level];
+            node *succs[max_level];
+            if (!locate(key, preds, succs))
+            {
+                return false;
+            }
+            node *victim = succs[0];
+
+            // 自顶向下给各层打删除标记
+            for (int level = victim->levels - 1; level >= 1; --level)
+            {
+                uintptr_t succ = victim->next[level].load();
+                while (!marked(succ))
+                {
+                    victim->next[level].compare_exchange_weak(succ, succ | 1);
+                }
+            }
+
+            // 最底层打上标记的线程才算删除成功
+            uintptr_t succ = victim->next[0].load();
+            while (true)
+            {
+                if (marked(succ))
+                {
+                    return false;
+                }
+                if (victim->next[0].compare_exchange_strong(succ, succ | 1))
+                {
+                    break;
+                }
+            }
+            size_.fetch_sub(1);
+            locate(key, preds, succs); // 物理摘除
+            finish(victim, remove_done);
+            return true;
+        }
+
+        // 按键升序访问 [lo, hi) 范围内未被删除的元素，fn(key, value)
+        template <typename Fn>
+        void for_each_range(const K &lo, const K &hi, Fn fn)
+        {
+            epoch_guard guard;
+            for (node *curr = lower_bound_node(lo); curr && less(curr->key, hi);
+                 curr = ptr(curr->next[0].load()))
+            {
+                if (!marked(curr->next[0].load()))
+                {
+                    fn(curr->key, curr->value);
+                }
+            }
+        }
+
+        // 按键升序访问所有未被删除的元素
+        template <typename Fn>
+        void for_each(Fn fn)
+        {
+            epoch_guard guard;
+            for (node *curr = ptr(head_[0].load()); curr; curr = ptr(curr->next[0].load()))
+            {
+                if (!marked(curr->next[0].load()))
+                {
+                    fn(curr->key, curr->value);
+                }
+            }
+        }
+
+        // 近似元素数，并发修改时只是一个快照
+        size_t size() const { return size_.load(); }
+
+        bool empty() const { return size() == 0; }
+    };
+}
+
+#endif // CONCURRENT_SKIPLIST_MAP_H
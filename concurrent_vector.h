@@ -0,0 +1,259 @@
+#ifndef CONCURRENT_VECTOR_H
+#define CONCURRENT_VECTOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include "allocator.h"
+
+namespace kad
+{
+    // 可并发增长的分段 vector：元素存放在大小为 2 的幂的段里，段一旦分配就不再移动，
+    // 因此元素地址稳定，读线程可以在其它线程追加时无锁、无等待地按下标访问。
+    // 段 0 存放下标 [0, 2)，段 k (k >= 1) 存放下标 [2^k, 2^(k+1))。
+    // 追加时先用 reserved_ 领取下标，构造元素后把该槽位标记为已构造，
+    // 再尽量把 size_ 向前推过连续的已完成槽位（帮助推进），不等待其它追加方，
+    // 所以 size() 以内的槽位都已完成，读线程可以放心扫描 [0, size())。
+    // 构造抛异常的槽位标记为跳过，size_ 照样越过它，at() 访问它时抛异常；
+    // 被抢占的追加方只会让 size() 暂时停在它的下标之前，不会阻塞其它追加。
+    // 只有槽位状态数组本身分配失败时该槽位无法标记，size() 会一直停在它之前。
+    template <typename T, typename alloc = kad::allocator<T>>
+    class concurrent_vector
+    {
+    public:
+        using size_type = size_t;
+        using value_type = T;
+
+    private:
+        static const size_type num_segments = sizeof(size_type) * 8;
+
+        // 槽位状态
+        static const unsigned char slot_empty = 0;
+        static const unsigned char slot_constructed = 1;
+        static const unsigned char slot_skipped = 2; // 构造失败，没有对象
+
+        std::atomic<T *> segments_[num_segments];
+        std::atomic<std::atomic<unsigned char> *> states_[num_segments]; // 与 segments_ 一一对应
+        std::atomic<size_type> reserved_; // 已领取的下标数
+        std::atomic<size_type> size_;     // [0, size_) 的槽位都已完成（已构造或已跳过）
+        alloc allocator_;
+
+        // floor(log2(i | 1))
+        static size_type segment_of(size_type i)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(static_cast<unsigned long long>(i | 1));
+#else
+            size_type k = 0;
+            for (size_type v = i | 1; v > 1; v >>= 1)
+            {
+                ++k;
+            }
+            return k;
+#endif
+        }
+
+        static size_type segment_base(size_type k)
+        {
+            return k ? size_type(1) << k : 0;
+        }
+
+        static size_type segment_size(size_type k)
+        {
+            return k ? size_type(1) << k : 2;
+        }
+
+        // 段不存在时分配；多个线程同时分配时只有一个 CAS 成功，其余释放自己的内存
+        T *ensure_segment(size_type k)
+        {
+            T *seg = segments_[k].load(std::memory_order_acquire);
+            if (seg)
+            {
+                return seg;
+            }
+            T *fresh = allocator_.allocate(segment_size(k));
+            if (segments_[k].compare_exchange_strong(seg, fresh, std::memory_order_acq_rel))
+            {
+                return fresh;
+            }
+            allocator_.deallocate(fresh, segment_size(k));
+            return seg;
+        }
+
+        // 段 k 的状态数组不存在时分配，做法同 ensure_segment
+        std::atomic<unsigned char> *ensure_states(size_type k)
+        {
+            std::atomic<unsigned char> *states = states_[k].load(std::memory_order_acquire);
+            if (states)
+            {
+                return states;
+            }
+            std::atomic<unsigned char> *fresh = new std::atomic<unsigned char>[segment_size(k)]();
+            if (states_[k].compare_exchange_strong(states, fresh, std::memory_order_acq_rel))
+            {
+                return fresh;
+            }
+            delete[] fresh;
+            return states;
+        }
+
+        T *slot(size_type i) const
+        {
+            size_type k = segment_of(i);
+            return segments_[k].load(std::memory_order_acquire) + (i - segment_base(k));
+        }
+
+        // 槽位状态，状态数组尚未分配时为 slot_empty
+        unsigned char state(size_type i) const
+        {
+            size_type k = segment_of(i);
+            std::atomic<unsigned char> *states = states_[k].load(std::memory_order_acquire);
+            return states ? states[i - segment_base(k)].load() : slot_empty;
+        }
+
+        // 把 size_ 推过从它开始的连续已完成槽位。
+        // 标记槽位和读 size_ 都是 seq_cst：标记方和推进方至少有一方能看到对方，不会漏推
+        void advance()
+        {
+            size_type n = size_.load();
+            while (state(n) != slot_empty)
+            {
+                if (size_.compare_exchange_weak(n, n + 1))
+                {
+                    ++n;
+                }
+            }
+        }
+
+        // 在已领取的 [first, first + n) 上逐个构造 value 的副本，完成后帮助推进 size_。
+        // 某个槽位分配或构造抛异常时标记为跳过，剩下的槽位也标记为跳过，然后重新抛出
+        void append(size_type first, size_type n, const T &value)
+        {
+            size_type i = first;
+            try
+            {
+                for (; i < first + n; ++i)
+                {
+                    size_type k = segment_of(i);
+                    std::atomic<unsigned char> *states = ensure_states(k);
+                    T *seg = ensure_segment(k);
+                    allocator_.construct(seg + (i - segment_base(k)), value);
+                    states[i - segment_base(k)].store(slot_constructed);
+                }
+            }
+            catch (...)
+            {
+                try
+                {
+                    for (; i < first + n; ++i)
+                    {
+                        size_type k = segment_of(i);
+                        ensure_states(k)[i - segment_base(k)].store(slot_skipped);
+                    }
+                }
+                catch (...)
+                {
+                    // 状态数组分配失败，剩下的槽位无法标记
+                }
+                advance();
+                throw;
+            }
+            advance();
+        }
+
+    public:
+        concurrent_vector() : reserved_(0), size_(0)
+        {
+            for (size_type k = 0; k < num_segments; ++k)
+            {
+                segments_[k].store(nullptr, std::memory_order_relaxed);
+                states_[k].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        ~concurrent_vector()
+        {
+            size_type n = reserved_.load(std::memory_order_relaxed);
+            for (size_type i = 0; i < n; ++i)
+            {
+                if (state(i) == slot_constructed)
+                {
+                    allocator_.destroy(slot(i));
+                }
+            }
+            for (size_type k = 0; k < num_segments; ++k)
+            {
+                T *seg = segments_[k].load(std::memory_order_relaxed);
+                if (seg)
+                {
+                    allocator_.deallocate(seg, segment_size(k));
+                }
+                delete[] states_[k].load(std::memory_order_relaxed);
+            }
+        }
+
+        concurrent_vector(const concurrent_vector &) = delete;
+        concurrent_vector &operator=(const concurrent_vector &) = delete;
+
+        // 追加一个元素，返回它的下标。返回时元素已构造，但前面还有未完成的追加时
+        // size() 可能还不包含它；用返回的下标访问总是安全的
+        size_type push_back(const T &value)
+        {
+            size_type i = reserved_.fetch_add(1, std::memory_order_relaxed);
+            append(i, 1, value);
+            return i;
+        }
+
+        // 一次追加 n 个 value 的副本，返回第一个新元素的下标
+        size_type grow_by(size_type n, const T &value = T())
+        {
+            size_type first = reserved_.fetch_add(n, std::memory_order_relaxed);
+            append(first, n, value);
+            return first;
+        }
+
+        // 无等待下标访问，不检查。i 必须来自已返回的 push_back/grow_by，
+        // 或小于某次读到的 size() 且该槽位没有被跳过（见 is_constructed）
+        T &operator[](size_type i)
+        {
+            return *slot(i);
+        }
+
+        const T &operator[](size_type i) const
+        {
+            return *slot(i);
+        }
+
+        T &at(size_type i)
+        {
+            if (i >= size())
+            {
+                throw std::out_of_range("concurrent_vector::at(): index out of range");
+            }
+            if (state(i) != slot_constructed)
+            {
+                throw std::runtime_error("concurrent_vector::at(): element construction failed");
+            }
+            return *slot(i);
+        }
+
+        // 下标 i 处是否有已构造的元素；追加失败留下的槽位返回 false
+        bool is_constructed(size_type i) const
+        {
+            return state(i) == slot_constructed;
+        }
+
+        // 已完成的槽位数，[0, size()) 可以通过 at() 安全访问
+        size_type size() const
+        {
+            return size_.load(std::memory_order_acquire);
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+    };
+}
+
+#endif // CONCURRENT_VECTOR_H
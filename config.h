@@ -0,0 +1,44 @@
+#ifndef KAD_CONFIG_H
+#define KAD_CONFIG_H
+
+#include <cassert>
+#include <stdexcept> // for std::out_of_range
+
+// 容器访问函数（operator[]、front、back、按下标插入等）的边界检查级别：
+//   0 - 不检查，没有任何额外开销，适合 release 热循环
+//   1 - 只用 assert 检查，定义 NDEBUG 后等同于 0（默认：debug 构建检查，release 构建没有开销）
+//   2 - 越界时抛出 std::out_of_range，release 构建也检查，需要显式开启
+// 需要在包含任何 kad 头文件之前定义，或在构建时用 -DKAD_BOUNDS_CHECK=N 指定
+#define KAD_BOUNDS_UNCHECKED 0
+#define KAD_BOUNDS_ASSERT 1
+#define KAD_BOUNDS_THROW 2
+
+#ifndef KAD_BOUNDS_CHECK
+#define KAD_BOUNDS_CHECK KAD_BOUNDS_ASSERT
+#endif
+
+#if KAD_BOUNDS_CHECK == KAD_BOUNDS_THROW
+#define KAD_CHECK_BOUNDS(cond, msg)          \
+    do                                       \
+    {                                        \
+        if (!(cond))                         \
+        {                                    \
+            throw std::out_of_range(msg);    \
+        }                                    \
+    } while (0)
+#elif KAD_BOUNDS_CHECK == KAD_BOUNDS_ASSERT
+#define KAD_CHECK_BOUNDS(cond, msg) assert((cond) && msg)
+#else
+#define KAD_CHECK_BOUNDS(cond, msg) ((void)0)
+#endif
+
+// 软件预取，不支持的编译器上为空操作。预取只是提示，地址越界也不会出错
+#ifndef KAD_PREFETCH
+#if defined(__GNUC__) || defined(__clang__)
+#define KAD_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define KAD_PREFETCH(addr) ((void)(addr))
+#endif
+#endif
+
+#endif // KAD_CONFIG_H
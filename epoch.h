@@ -0,0 +1,189 @@
+#ifndef KAD_EPOCH_H
+#define KAD_EPOCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace kad
+{
+    // 基于纪元的内存回收（EBR）：读线程在 epoch_guard 作用域内访问无锁结构，
+    // 被摘下的节点交给 epoch_retire，等所有活跃线程都进入了之后的纪元再真正释放
+    namespace epoch_detail
+    {
+        const size_t max_threads = 256;
+        const size_t collect_interval = 64; // 每退休这么多个对象尝试一次推进纪元和回收
+
+        struct alignas(64) thread_record
+        {
+            std::atomic<uint64_t> epoch;
+            std::atomic<bool> active;
+            std::atomic<bool> in_use;
+        };
+
+        struct retired
+        {
+            void *ptr;
+            void (*deleter)(void *);
+            uint64_t epoch;
+        };
+
+        struct domain
+        {
+            std::atomic<uint64_t> global_epoch;
+            thread_record records[max_threads];
+            std::mutex orphan_mutex;
+            std::vector<retired> orphans; // 已退出线程留下的待回收对象
+
+            domain() : global_epoch(2)
+            {
+                for (size_t i = 0; i < max_threads; ++i)
+                {
+                    records[i].epoch.store(0, std::memory_order_relaxed);
+                    records[i].active.store(false, std::memory_order_relaxed);
+                    records[i].in_use.store(false, std::memory_order_relaxed);
+                }
+            }
+
+            // 所有活跃线程都已看到当前纪元时推进一格
+            void try_advance()
+            {
+                uint64_t e = global_epoch.load();
+                for (size_t i = 0; i < max_threads; ++i)
+                {
+                    thread_record &r = records[i];
+                    if (r.in_use.load() && r.active.load() && r.epoch.load() != e)
+                    {
+                        return;
+                    }
+                }
+                global_epoch.compare_exchange_strong(e, e + 1);
+            }
+
+            // 释放退休纪元比当前纪元早两格以上的对象
+            static void collect(std::vector<retired> &list, uint64_t now)
+            {
+                size_t kept = 0;
+                for (size_t i = 0; i < list.size(); ++i)
+                {
+                    if (list[i].epoch + 2 <= now)
+                    {
+                        list[i].deleter(list[i].ptr);
+                    }
+                    else
+                    {
+                        list[kept++] = list[i];
+                    }
+                }
+                list.resize(kept);
+            }
+        };
+
+        // 故意不析构，线程退出时仍可访问
+        inline domain &global_domain()
+        {
+            static domain *d = new domain();
+            return *d;
+        }
+
+        struct thread_state
+        {
+            thread_record *record;
+            size_t depth;
+            size_t retire_count;
+            std::vector<retired> limbo;
+
+            thread_state() : record(nullptr), depth(0), retire_count(0)
+            {
+                domain &d = global_domain();
+                for (size_t i = 0; i < max_threads; ++i)
+                {
+                    bool expected = false;
+                    if (d.records[i].in_use.compare_exchange_strong(expected, true))
+                    {
+                        record = &d.records[i];
+                        return;
+                    }
+                }
+                throw std::runtime_error("epoch: too many threads");
+            }
+
+            ~thread_state()
+            {
+                domain &d = global_domain();
+                if (!limbo.empty())
+                {
+                    std::lock_guard<std::mutex> lock(d.orphan_mutex);
+                    d.orphans.insert(d.orphans.end(), limbo.begin(), limbo.end());
+                }
+                record->active.store(false);
+                record->in_use.store(false);
+            }
+
+            void reclaim()
+            {
+                domain &d = global_domain();
+                d.try_advance();
+                uint64_t now = d.global_epoch.load();
+                domain::collect(limbo, now);
+                std::unique_lock<std::mutex> lock(d.orphan_mutex, std::try_to_lock);
+                if (lock.owns_lock())
+                {
+                    domain::collect(d.orphans, now);
+                }
+            }
+        };
+
+        inline thread_state &local_state()
+        {
+            static thread_local thread_state state;
+            return state;
+        }
+    }
+
+    // 作用域内受保护：期间读到的节点不会被释放。可以嵌套
+    class epoch_guard
+    {
+    private:
+        epoch_detail::thread_state &state;
+
+    public:
+        epoch_guard() : state(epoch_detail::local_state())
+        {
+            if (state.depth++ == 0)
+            {
+                state.record->epoch.store(epoch_detail::global_domain().global_epoch.load());
+                state.record->active.store(true);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+        ~epoch_guard()
+        {
+            if (--state.depth == 0)
+            {
+                state.record->active.store(false, std::memory_order_release);
+            }
+        }
+
+        epoch_guard(const epoch_guard &) = delete;
+        epoch_guard &operator=(const epoch_guard &) = delete;
+    };
+
+    // 延迟释放 ptr：调用前 ptr 必须已经从结构中摘下，其它线程无法再新读到它
+    inline void epoch_retire(void *ptr, void (*deleter)(void *))
+    {
+        epoch_detail::thread_state &state = epoch_detail::local_state();
+        epoch_detail::retired r = {ptr, deleter, epoch_detail::global_domain().global_epoch.load()};
+        state.limbo.push_back(r);
+        if (++state.retire_count % epoch_detail::collect_interval == 0)
+        {
+            state.reclaim();
+        }
+    }
+}
+
+#endif // KAD_EPOCH_H
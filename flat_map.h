@@ -0,0 +1,224 @@
+#ifndef FLAT_MAP_H
+#define FLAT_MAP_H
+
+#include <algorithm> // for std::stable_sort
+#include <cstddef>
+#include <vector>
+#include "config.h"
+#include "vector.h"
+
+namespace kad
+{
+    // 有序连续存储的只读友好映射：键和值分别存放在两个按键排序的 kad::vector 中。
+    // 适合批量构建后大量查询的数据；查找默认用无分支二分，
+    // 也可以额外建立 Eytzinger（BFS 顺序）索引，配合预取减少缓存缺失。
+    template <typename K, typename V>
+    class flat_map
+    {
+    private:
+        vector<K> keys_;
+        vector<V> values_;
+
+        // Eytzinger 索引：eytz_[1..n] 按完全二叉树的 BFS 顺序存放键，
+        // eytz_pos_[k] 为该位置对应的有序下标
+        vector<K> eytz_;
+        vector<size_t> eytz_pos_;
+        bool use_index_;
+
+        // 一条 64 字节缓存行容纳的节点数，至少为 1
+        static const size_t prefetch_stride = sizeof(K) < 64 ? 64 / sizeof(K) : 1;
+
+        // 按中序遍历把有序数组填进 BFS 布局
+        size_t fill_index(size_t i, size_t k)
+        {
+            size_t n = keys_.size();
+            if (k <= n)
+            {
+                i = fill_index(i, 2 * k);
+                eytz_[k] = keys_[i];
+                eytz_pos_[k] = i;
+                ++i;
+                i = fill_index(i, 2 * k + 1);
+            }
+            return i;
+        }
+
+        void rebuild_index()
+        {
+            eytz_.clear();
+            eytz_pos_.clear();
+            if (!use_index_)
+            {
+                return;
+            }
+            size_t n = keys_.size();
+            eytz_.reserve(n + 1);
+            eytz_pos_.reserve(n + 1);
+            for (size_t k = 0; k <= n; ++k)
+            {
+                eytz_.push_back(K());
+                eytz_pos_.push_back(n);
+            }
+            fill_index(0, 1);
+        }
+
+        // 无分支二分查找
+        size_t branchless_lower_bound(const K &key) const
+        {
+            const K *first = keys_.data();
+            size_t n = keys_.size();
+            if (n == 0)
+            {
+                return 0;
+            }
+            const K *base = first;
+            while (n > 1)
+            {
+                size_t half = n / 2;
+                base = (base[half - 1] < key) ? base + half : base;
+                n -= half;
+            }
+            return (base - first) + (*base < key);
+        }
+
+        size_t eytzinger_lower_bound(const K &key) const
+        {
+            const K *eytz = eytz_.data();
+            size_t n = keys_.size();
+            size_t k = 1;
+            while (k <= n)
+            {
+                // 预取四层之后的子树：16 个节点相邻存放，可能跨多条缓存行，每行预取一次
+                for (size_t j = 0; j < 16; j += prefetch_stride)
+                {
+                    KAD_PREFETCH(eytz + k * 16 + j);
+                }
+                k = 2 * k + (eytz[k] < key);
+            }
+            // 去掉最后一串向右走的步骤，回到最后一次向左走的节点
+            while (k & 1)
+            {
+                k >>= 1;
+            }
+            k >>= 1;
+            return k == 0 ? n : eytz_pos_.data()[k];
+        }
+
+        void assign(vector<K> &keys, vector<V> &values)
+        {
+            keys_.swap(keys);
+            values_.swap(values);
+            rebuild_index();
+        }
+
+    public:
+        flat_map() : use_index_(false) {}
+
+        // 从未排序的输入批量构建：排序一次并去重，重复的键保留最后出现的值
+        void build(const K *keys, const V *values, size_t n)
+        {
+            std::vector<size_t> order(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(), [keys](size_t a, size_t b) {
+                return keys[a] < keys[b];
+            });
+
+            vector<K> new_keys;
+            vector<V> new_values;
+            new_keys.reserve(n);
+            new_values.reserve(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                // 相等键中取最后一个
+                if (i + 1 < n && !(keys[order[i]] < keys[order[i + 1]]))
+                {
+                    continue;
+                }
+                new_keys.push_back(keys[order[i]]);
+                new_values.push_back(values[order[i]]);
+            }
+            assign(new_keys, new_values);
+        }
+
+        // 合并一段已排序且无重复的数据，相同的键用新值覆盖，O(size + n)
+        void merge_sorted(const K *keys, const V *values, size_t n)
+        {
+            vector<K> new_keys;
+            vector<V> new_values;
+            new_keys.reserve(keys_.size() + n);
+            new_values.reserve(keys_.size() + n);
+
+            size_t i = 0, j = 0, m = keys_.size();
+            while (i < m || j < n)
+            {
+                if (j == n || (i < m && keys_[i] < keys[j]))
+                {
+                    new_keys.push_back(keys_[i]);
+                    new_values.push_back(values_[i]);
+                    ++i;
+                }
+                else
+                {
+                    if (i < m && !(keys[j] < keys_[i]))
+                    {
+                        ++i; // 键相同，丢弃旧值
+                    }
+                    new_keys.push_back(keys[j]);
+                    new_values.push_back(values[j]);
+                    ++j;
+                }
+            }
+            assign(new_keys, new_values);
+        }
+
+        // 启用或关闭 Eytzinger 索引；启用后每次 build/merge_sorted 都会重建
+        void use_eytzinger(bool enable)
+        {
+            use_index_ = enable;
+            rebuild_index();
+        }
+
+        // 第一个不小于 key 的元素下标，不存在时返回 size()
+        size_t lower_bound(const K &key) const
+        {
+            return use_index_ ? eytzinger_lower_bound(key) : branchless_lower_bound(key);
+        }
+
+        // 查找元素，未找到返回 nullptr
+        V *find(const K &key)
+        {
+            size_t i = lower_bound(key);
+            if (i == keys_.size() || key < keys_.data()[i])
+            {
+                return nullptr;
+            }
+            return values_.data() + i;
+        }
+
+        bool contains(const K &key) const
+        {
+            size_t i = lower_bound(key);
+            return i != keys_.size() && !(key < keys_.data()[i]);
+        }
+
+        // 按有序下标访问
+        const K &key_at(size_t i) const { return keys_.data()[i]; }
+        V &value_at(size_t i) { return values_.data()[i]; }
+
+        size_t size() const { return keys_.size(); }
+
+        bool empty() const { return keys_.empty(); }
+
+        void clear()
+        {
+            keys_.clear();
+            values_.clear();
+            rebuild_index();
+        }
+    };
+}
+
+#endif // FLAT_MAP_H
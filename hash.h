@@ -0,0 +1,121 @@
+#ifndef KAD_HASH_H
+#define KAD_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // for std::memcpy
+
+namespace kad
+{
+    // wyhash 风格的非加密哈希：每 16 字节做一次 64x64->128 位乘法混合，
+    // 短串只读首尾几个字，速度远高于逐字节哈希
+    namespace hash_detail
+    {
+        const uint64_t secret0 = 0xa0761d6478bd642fULL;
+        const uint64_t secret1 = 0xe7037ed1a0b428dbULL;
+        const uint64_t secret2 = 0x8ebc6af09c88c6e3ULL;
+        const uint64_t secret3 = 0x589965cc75374cc3ULL;
+
+        // 128 位乘积的低、高 64 位
+        inline void mum(uint64_t &a, uint64_t &b)
+        {
+#if defined(__SIZEOF_INT128__)
+            __uint128_t r = static_cast<__uint128_t>(a) * b;
+            a = static_cast<uint64_t>(r);
+            b = static_cast<uint64_t>(r >> 64);
+#else
+            uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+            uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+            uint64_t t = rl + (rm0 << 32);
+            uint64_t c = t < rl;
+            uint64_t lo = t + (rm1 << 32);
+            c += lo < t;
+            a = lo;
+            b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+        }
+
+        inline uint64_t mix(uint64_t a, uint64_t b)
+        {
+            mum(a, b);
+            return a ^ b;
+        }
+
+        inline uint64_t read64(const uint8_t *p)
+        {
+            uint64_t v;
+            std::memcpy(&v, p, 8);
+            return v;
+        }
+
+        inline uint64_t read32(const uint8_t *p)
+        {
+            uint32_t v;
+            std::memcpy(&v, p, 4);
+            return v;
+        }
+
+        // 1 到 3 字节
+        inline uint64_t read_small(const uint8_t *p, size_t k)
+        {
+            return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+        }
+    }
+
+    inline uint64_t hash_bytes(const void *key, size_t len, uint64_t seed = 0)
+    {
+        using namespace hash_detail;
+        const uint8_t *p = static_cast<const uint8_t *>(key);
+        seed ^= mix(seed ^ secret0, secret1);
+        uint64_t a, b;
+        if (len <= 16)
+        {
+            if (len >= 4)
+            {
+                size_t step = (len >> 3) << 2;
+                a = (read32(p) << 32) | read32(p + step);
+                b = (read32(p + len - 4) << 32) | read32(p + len - 4 - step);
+            }
+            else if (len > 0)
+            {
+                a = read_small(p, len);
+                b = 0;
+            }
+            else
+            {
+                a = b = 0;
+            }
+        }
+        else
+        {
+            size_t i = len;
+            if (i > 48)
+            {
+                uint64_t see1 = seed, see2 = seed;
+                do
+                {
+                    seed = mix(read64(p) ^ secret1, read64(p + 8) ^ seed);
+                    see1 = mix(read64(p + 16) ^ secret2, read64(p + 24) ^ see1);
+                    see2 = mix(read64(p + 32) ^ secret3, read64(p + 40) ^ see2);
+                    p += 48;
+                    i -= 48;
+                } while (i > 48);
+                seed ^= see1 ^ see2;
+            }
+            while (i > 16)
+            {
+                seed = mix(read64(p) ^ secret1, read64(p + 8) ^ seed);
+                i -= 16;
+                p += 16;
+            }
+            a = read64(p + i - 16);
+            b = read64(p + i - 8);
+        }
+        a ^= secret1;
+        b ^= seed;
+        mum(a, b);
+        return mix(a ^ secret0 ^ len, b ^ secret1);
+    }
+}
+
+#endif // KAD_HASH_H
@@ -0,0 +1,238 @@
+#ifndef INTRUSIVE_LIST_H
+#define INTRUSIVE_LIST_H
+
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+
+namespace kad {
+
+    // 嵌入到用户对象中的链表指针。未链接时两个指针都为空
+    struct list_hook {
+        list_hook* prev;
+        list_hook* next;
+
+        list_hook() : prev(nullptr), next(nullptr) {}
+
+        // 拷贝对象时不复制链接关系
+        list_hook(const list_hook&) : prev(nullptr), next(nullptr) {}
+        list_hook& operator=(const list_hook&) { return *this; }
+
+        // 对象销毁前必须先从链表中摘下
+        ~list_hook() {
+            assert(!is_linked() && "object destroyed while still linked into an intrusive_list");
+        }
+
+        bool is_linked() const {
+            return next != nullptr;
+        }
+    };
+
+    // 侵入式双向链表：prev/next 存放在对象自身的 list_hook 成员中，
+    // 链表不分配、不拷贝、也不拥有对象，push/erase/splice 都是 O(1)。
+    // 一个对象有几个 hook 成员就能同时挂在几个链表上。
+    template <typename T, list_hook T::*Hook>
+    class intrusive_list {
+    private:
+        list_hook root; // 环形链表的哨兵节点
+        size_t size_;
+
+        static list_hook* hook_of(T& obj) {
+            return &(obj.*Hook);
+        }
+
+        // 由 hook 地址反推所属对象
+        static T* owner_of(list_hook* hook) {
+            return reinterpret_cast<T*>(reinterpret_cast<char*>(hook) - hook_offset());
+        }
+
+        // hook 成员在对象内的偏移，只计算一次
+        static std::ptrdiff_t hook_offset() {
+            alignas(T) static char probe[sizeof(T)];
+            static const std::ptrdiff_t offset =
+                reinterpret_cast<char*>(&(reinterpret_cast<T*>(probe)->*Hook)) - probe;
+            return offset;
+        }
+
+        static void link_before(list_hook* pos, list_hook* hook) {
+            hook->next = pos;
+            hook->prev = pos->prev;
+            pos->prev->next = hook;
+            pos->prev = hook;
+        }
+
+        static void unlink(list_hook* hook) {
+            hook->prev->next = hook->next;
+            hook->next->prev = hook->prev;
+            hook->prev = nullptr;
+            hook->next = nullptr;
+        }
+
+        void check_unlinked(T& obj) {
+            if (hook_of(obj)->is_linked()) {
+                throw std::logic_error("intrusive_list: object is already linked");
+            }
+        }
+
+    public:
+        // 迭代器支持
+        class iterator {
+        private:
+            list_hook* current;
+            friend class intrusive_list;
+
+        public:
+            explicit iterator(list_hook* hook) : current(hook) {}
+
+            T& operator*() {
+                return *owner_of(current);
+            }
+
+            T* operator->() {
+                return owner_of(current);
+            }
+
+            iterator& operator++() {
+                current = current->next;
+                return *this;
+            }
+
+            iterator& operator--() {
+                current = current->prev;
+                return *this;
+            }
+
+            bool operator!=(const iterator& other) const {
+                return current != other.current;
+            }
+
+            bool operator==(const iterator& other) const {
+                return current == other.current;
+            }
+        };
+
+        intrusive_list() : size_(0) {
+            root.prev = &root;
+            root.next = &root;
+        }
+
+        // 析构时摘下所有对象，对象本身不受影响
+        ~intrusive_list() {
+            clear();
+            root.prev = nullptr;
+            root.next = nullptr;
+        }
+
+        intrusive_list(const intrusive_list&) = delete;
+        intrusive_list& operator=(const intrusive_list&) = delete;
+
+        iterator begin() {
+            return iterator(root.next);
+        }
+
+        iterator end() {
+            return iterator(&root);
+        }
+
+        // 对象所在位置的迭代器，对象必须在本链表中
+        iterator iterator_to(T& obj) {
+            return iterator(hook_of(obj));
+        }
+
+        // 在 pos 之前插入对象
+        void insert(iterator pos, T& obj) {
+            check_unlinked(obj);
+            link_before(pos.current, hook_of(obj));
+            ++size_;
+        }
+
+        void push_back(T& obj) {
+            insert(end(), obj);
+        }
+
+        void push_front(T& obj) {
+            insert(begin(), obj);
+        }
+
+        T& front() {
+            return *owner_of(root.next);
+        }
+
+        T& back() {
+            return *owner_of(root.prev);
+        }
+
+        void pop_front() {
+            if (size_) {
+                unlink(root.next);
+                --size_;
+            }
+        }
+
+        void pop_back() {
+            if (size_) {
+                unlink(root.prev);
+                --size_;
+            }
+        }
+
+        // 把对象从本链表中摘下。对象未链接时抛出异常；
+        // 无法在 O(1) 内检查对象是否属于另一个链表，这一点由调用方保证
+        void erase(T& obj) {
+            list_hook* hook = hook_of(obj);
+            if (!hook->is_linked()) {
+                throw std::logic_error("intrusive_list::erase(): object is not linked");
+            }
+            unlink(hook);
+            --size_;
+        }
+
+        // 把 other 中的对象移动到本链表的 pos 之前；pos 就是该对象时不做任何事
+        void splice(iterator pos, intrusive_list& other, T& obj) {
+            if (pos.current == hook_of(obj)) {
+                return;
+            }
+            other.erase(obj);
+            link_before(pos.current, hook_of(obj));
+            ++size_;
+        }
+
+        // 把 other 的全部对象移动到本链表的 pos 之前，O(1)
+        void splice(iterator pos, intrusive_list& other) {
+            if (other.empty() || &other == this) {
+                return;
+            }
+            list_hook* first = other.root.next;
+            list_hook* last = other.root.prev;
+            other.root.next = &other.root;
+            other.root.prev = &other.root;
+
+            first->prev = pos.current->prev;
+            pos.current->prev->next = first;
+            last->next = pos.current;
+            pos.current->prev = last;
+
+            size_ += other.size_;
+            other.size_ = 0;
+        }
+
+        // 摘下所有对象
+        void clear() {
+            while (size_) {
+                pop_front();
+            }
+        }
+
+        // 获取链表大小
+        size_t size() const {
+            return size_;
+        }
+
+        // 判断链表是否为空
+        bool empty() const {
+            return size_ == 0;
+        }
+    };
+}
+
+#endif // INTRUSIVE_LIST_H
@@ -5,6 +5,7 @@
 #include <memory>  // for std::allocator
 #include <iterator>  // for std::iterator, std::advance
 #include "allocator.h"
+#include "config.h"
 
 namespace kad {
 
@@ -40,6 +41,38 @@ namespace kad {
             allocator_.deallocate(node, 1);
         }
 
+        // 把节点从链表中摘下（不释放）
+        void unlink(Node<T>* node) {
+            if (node->prev) {
+                node->prev->next = node->next;
+            } else {
+                head = node->next;
+            }
+            if (node->next) {
+                node->next->prev = node->prev;
+            } else {
+                tail = node->prev;
+            }
+            node->next = nullptr;
+            node->prev = nullptr;
+        }
+
+        // 把节点挂到 pos 之前，pos 为空则挂到尾部
+        void link_before(Node<T>* pos, Node<T>* node) {
+            node->next = pos;
+            node->prev = pos ? pos->prev : tail;
+            if (node->prev) {
+                node->prev->next = node;
+            } else {
+                head = node;
+            }
+            if (pos) {
+                pos->prev = node;
+            } else {
+                tail = node;
+            }
+        }
+
     public:
         // 构造函数
         list() : head(nullptr), tail(nullptr), size_(0) {}
@@ -77,9 +110,7 @@ namespace kad {
 
         // 在指定位置插入元素
         void insert(size_t index, const T& value) {
-            if (index > size_) {
-                throw std::out_of_range("Index out of range");
-            }
+            KAD_CHECK_BOUNDS(index <= size_, "list::insert(): index out of range");
 
             if (index == 0) {
                 push_front(value);
@@ -135,6 +166,17 @@ namespace kad {
             }
         }
 
+        // 访问头尾元素
+        T& front() {
+            KAD_CHECK_BOUNDS(head != nullptr, "list::front(): empty list");
+            return head->data;
+        }
+
+        T& back() {
+            KAD_CHECK_BOUNDS(tail != nullptr, "list::back(): empty list");
+            return tail->data;
+        }
+
         // 获取链表大小
         size_t size() const {
             return size_;
@@ -156,6 +198,7 @@ namespace kad {
         class iterator {
         private:
             Node<T>* current;
+            friend class list;
 
         public:
             iterator(Node<T>* node) : current(node) {}
@@ -164,6 +207,10 @@ namespace kad {
                 return current->data;
             }
 
+            T* operator->() {
+                return &current->data;
+            }
+
             iterator& operator++() {
                 current = current->next;
                 return *this;
@@ -177,8 +224,40 @@ namespace kad {
             bool operator!=(const iterator& other) const {
                 return current != other.current;
             }
+
+            bool operator==(const iterator& other) const {
+                return current == other.current;
+            }
         };
 
+        // 删除迭代器指向的节点，返回下一个位置，O(1)
+        iterator erase(iterator pos) {
+            Node<T>* node = pos.current;
+            Node<T>* next = node->next;
+            unlink(node);
+            destroy_node(node);
+            --size_;
+            return iterator(next);
+        }
+
+        // 把 other 中 it 指向的节点移动到 pos 之前（pos 为 end() 时移到尾部）
+        // 只改指针，不重新分配节点，O(1)
+        void splice(iterator pos, list& other, iterator it) {
+            Node<T>* node = it.current;
+            if (node == pos.current) {
+                return;
+            }
+            other.unlink(node);
+            --other.size_;
+            link_before(pos.current, node);
+            ++size_;
+        }
+
+        // 把节点移动到链表头部，O(1)
+        void move_to_front(iterator it) {
+            splice(begin(), *this, it);
+        }
+
         // 返回链表的开始迭代器
         iterator begin() {
             return iterator(head);
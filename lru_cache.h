@@ -0,0 +1,357 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional> // for std::hash
+#include <mutex>
+#include <utility>    // for std::pair, std::declval
+#include <vector>
+#include "list.h"
+#include "string.h"
+#include "unordered_map.h"
+
+namespace kad
+{
+    // 按条目计重：容量即条目数
+    template <typename K, typename V>
+    struct unit_weigher
+    {
+        size_t operator()(const K &, const V &) const { return 1; }
+    };
+
+    // 对象在自身之外（堆上）占用的字节数，byte_weigher 用它计入键和值的动态内存。
+    // 默认：有 data()、capacity() 和 value_type 的连续容器（std::string、std::vector 等）
+    // 按 capacity() * sizeof(value_type) 计，数据在对象内部（短字符串优化）时为 0；
+    // 其它类型为 0。自定义类型可以特化 heap_size
+    template <typename T, typename = void>
+    struct heap_size
+    {
+        size_t operator()(const T &) const { return 0; }
+    };
+
+    template <typename T>
+    struct heap_size<T, decltype(void(std::declval<const T &>().data()),
+                                 void(std::declval<const T &>().capacity()),
+                                 void(sizeof(typename T::value_type)))>
+    {
+        size_t operator()(const T &value) const
+        {
+            const char *p = reinterpret_cast<const char *>(value.data());
+            const char *self = reinterpret_cast<const char *>(&value);
+            if (p >= self && p < self + sizeof(T))
+            {
+                return 0;
+            }
+            return value.capacity() * sizeof(typename T::value_type);
+        }
+    };
+
+    template <typename T, typename alloc>
+    struct heap_size<basechar<T, alloc>, void>
+    {
+        size_t operator()(const basechar<T, alloc> &value) const { return value.size() + 1; }
+    };
+
+    // 按字节计重：容量即字节预算。每个条目计链表节点、索引中键和迭代器的固定开销，
+    // 再加上键和值在堆上的动态内存（见 heap_size）
+    template <typename K, typename V>
+    struct byte_weigher
+    {
+        size_t operator()(const K &key, const V &value) const
+        {
+            return sizeof(Node<std::pair<K, V>>) + sizeof(K) + sizeof(void *) * 3 +
+                   heap_size<K>()(key) * 2 + heap_size<V>()(value); // 键在链表和索引中各存一份
+        }
+    };
+
+    // 默认准入策略：新条目总是替换 LRU 尾部
+    template <typename K>
+    struct always_admit
+    {
+        explicit always_admit(size_t = 0) {}
+        void record(const K &) {}
+        bool admit(const K &, const K &) { return true; }
+    };
+
+    // TinyLFU 准入策略：用 count-min sketch 估计访问频率，
+    // 只有候选者的频率高于被淘汰者时才允许替换，防止一次性扫描冲掉热点
+    template <typename K>
+    class tinylfu_admit
+    {
+    private:
+        static const size_t depth = 4;
+        static const size_t max_width = size_t(1) << 20;
+        std::vector<uint8_t> counters; // depth 行，每行 width 个计数器
+        size_t width;
+        size_t additions;
+        size_t sample_size;
+
+        size_t index(size_t h, size_t row) const
+        {
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL + row * 0x9e3779b97f4a7c15ULL;
+            h ^= h >> 29;
+            return row * width + (h & (width - 1));
+        }
+
+        // 计数器整体减半，让频率随时间衰减
+        void reset()
+        {
+            for (auto &c : counters)
+            {
+                c >>= 1;
+            }
+            additions /= 2;
+        }
+
+    public:
+        explicit tinylfu_admit(size_t capacity = 1024) : width(1), additions(0)
+        {
+            while (width < capacity && width < max_width)
+            {
+                width <<= 1;
+            }
+            counters.assign(depth * width, 0);
+            sample_size = width * 10;
+        }
+
+        void record(const K &key)
+        {
+            size_t h = std::hash<K>{}(key);
+            for (size_t row = 0; row < depth; ++row)
+            {
+                uint8_t &c = counters[index(h, row)];
+                if (c < 15)
+                {
+                    ++c;
+                }
+            }
+            if (++additions >= sample_size)
+            {
+                reset();
+            }
+        }
+
+        size_t frequency(const K &key) const
+        {
+            size_t h = std::hash<K>{}(key);
+            size_t f = 15;
+            for (size_t row = 0; row < depth; ++row)
+            {
+                size_t c = counters[index(h, row)];
+                f = c < f ? c : f;
+            }
+            return f;
+        }
+
+        bool admit(const K &candidate, const K &victim)
+        {
+            return frequency(candidate) > frequency(victim);
+        }
+    };
+
+    // O(1) LRU 缓存：链表按访问顺序保存条目，哈希表保存键到链表节点的迭代器。
+    // 命中时只把节点 splice 到表头，不重新分配内存。
+    template <typename K, typename V,
+              typename Weigher = unit_weigher<K, V>,
+              typename Admission = always_admit<K>>
+    class lru_cache
+    {
+    private:
+        using entry_list = list<std::pair<K, V>>;
+        using entry_iterator = typename entry_list::iterator;
+
+        entry_list entries;                       // 表头最新，表尾最旧
+        unordered_map<K, entry_iterator> index;
+        size_t capacity_;                         // 以 Weigher 的单位计
+        size_t weight_;
+        Weigher weigher_;
+        Admission admission_;
+
+        void evict_one()
+        {
+            std::pair<K, V> &victim = entries.back();
+            weight_ -= weigher_(victim.first, victim.second);
+            index.erase(victim.first);
+            entries.pop_back();
+        }
+
+    public:
+        explicit lru_cache(size_t capacity)
+            : capacity_(capacity), weight_(0), admission_(capacity) {}
+
+        // kad::list 的拷贝是浅拷贝，index 里又存着指向 entries 的迭代器，禁止拷贝
+        lru_cache(const lru_cache &) = delete;
+        lru_cache &operator=(const lru_cache &) = delete;
+
+        // 查找并标记为最近使用，未命中返回 nullptr
+        V *get(const K &key)
+        {
+            admission_.record(key);
+            entry_iterator *it = index.find(key);
+            if (!it)
+            {
+                return nullptr;
+            }
+            entries.move_to_front(*it);
+            return &(*it)->second;
+        }
+
+        bool get(const K &key, V &out)
+        {
+            V *value = get(key);
+            if (!value)
+            {
+                return false;
+            }
+            out = *value;
+            return true;
+        }
+
+        // 插入或更新，超出容量时从尾部淘汰；返回条目是否在缓存中
+        bool put(const K &key, const V &value)
+        {
+            admission_.record(key);
+            size_t w = weigher_(key, value);
+            entry_iterator *it = index.find(key);
+            // 计入的重量按缓存中保存的副本计算，淘汰时减去的才会与之一致
+            //（byte_weigher 计入动态内存，副本的容量可能与参数不同）
+            if (it)
+            {
+                weight_ -= weigher_((*it)->first, (*it)->second);
+                (*it)->second = value;
+                weight_ += weigher_((*it)->first, (*it)->second);
+                entries.move_to_front(*it);
+            }
+            else
+            {
+                if (w > capacity_)
+                {
+                    return false;
+                }
+                if (weight_ + w > capacity_ && !entries.empty() &&
+                    !admission_.admit(key, entries.back().first))
+                {
+                    return false;
+                }
+                entries.push_front(std::make_pair(key, value));
+                index.insert(key, entries.begin());
+                weight_ += weigher_(entries.front().first, entries.front().second);
+            }
+
+            while (weight_ > capacity_ && entries.size() > 1)
+            {
+                evict_one();
+            }
+            return true;
+        }
+
+        bool erase(const K &key)
+        {
+            entry_iterator *it = index.find(key);
+            if (!it)
+            {
+                return false;
+            }
+            weight_ -= weigher_((*it)->first, (*it)->second);
+            entries.erase(*it);
+            index.erase(key);
+            return true;
+        }
+
+        bool contains(const K &key) const { return index.contains(key); }
+
+        size_t size() const { return entries.size(); }
+
+        bool empty() const { return entries.empty(); }
+
+        size_t capacity() const { return capacity_; }
+
+        // 当前占用（条目数或字节数，取决于 Weigher）
+        size_t weight() const { return weight_; }
+    };
+
+    // 线程安全的分片缓存：按哈希把键分到 Shards 个互相独立、各自加锁的 lru_cache
+    template <typename K, typename V, size_t Shards = 16,
+              typename Weigher = unit_weigher<K, V>,
+              typename Admission = always_admit<K>>
+    class sharded_lru_cache
+    {
+    private:
+        struct shard
+        {
+            std::mutex mutex;
+            lru_cache<K, V, Weigher, Admission> cache;
+
+            explicit shard(size_t capacity) : cache(capacity) {}
+        };
+
+        std::vector<shard *> shards;
+
+        shard &shard_for(const K &key)
+        {
+            size_t h = std::hash<K>{}(key);
+            // 取乘法混合后的高位选分片，与各分片内按低位选桶互不相关；
+            // 直接取模会让同一分片的键共享低位，只落在 1/Shards 的桶里
+            uint64_t m = static_cast<uint64_t>(h) * 0x9e3779b97f4a7c15ULL;
+            return *shards[((m >> 32) * Shards) >> 32];
+        }
+
+    public:
+        explicit sharded_lru_cache(size_t capacity)
+        {
+            size_t per_shard = (capacity + Shards - 1) / Shards;
+            for (size_t i = 0; i < Shards; ++i)
+            {
+                shards.push_back(new shard(per_shard));
+            }
+        }
+
+        ~sharded_lru_cache()
+        {
+            for (shard *s : shards)
+            {
+                delete s;
+            }
+        }
+
+        sharded_lru_cache(const sharded_lru_cache &) = delete;
+        sharded_lru_cache &operator=(const sharded_lru_cache &) = delete;
+
+        // 命中时把值拷贝到 out，锁外不暴露内部指针
+        bool get(const K &key, V &out)
+        {
+            shard &s = shard_for(key);
+            std::lock_guard<std::mutex> lock(s.mutex);
+            return s.cache.get(key, out);
+        }
+
+        bool put(const K &key, const V &value)
+        {
+            shard &s = shard_for(key);
+            std::lock_guard<std::mutex> lock(s.mutex);
+            return s.cache.put(key, value);
+        }
+
+        bool erase(const K &key)
+        {
+            shard &s = shard_for(key);
+            std::lock_guard<std::mutex> lock(s.mutex);
+            return s.cache.erase(key);
+        }
+
+        size_t size()
+        {
+            size_t total = 0;
+            for (shard *s : shards)
+            {
+                std::lock_guard<std::mutex> lock(s->mutex);
+                total += s->cache.size();
+            }
+            return total;
+        }
+    };
+}
+
+#endif // LRU_CACHE_H
@@ -3,29 +3,35 @@
 #include <iostream>
 #include <vector>
 #include "list.h"
+#include <functional> // for std::hash, std::equal_to
 #include <iterator>
 #include <utility>  // for std::pair
 
 namespace kad {
 
     // 哈希表中的桶结构，使用链表解决哈希冲突
-    template <typename Key, typename T>
+    // Hash 计算键的哈希值，KeyEqual 判断两个键是否相等
+    template <typename Key, typename T,
+              typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
     class map {
     private:
         // 哈希表每个桶存储一对键值对
         std::vector<list<std::pair<Key, T>>> table;
         size_t num_elements;
         size_t bucket_count;
+        Hash hasher;
+        KeyEqual key_equal;
 
         // 哈希函数（简单取余）
         size_t hash(const Key& key) const {
-            return std::hash<Key>{}(key) % bucket_count;
+            return hasher(key) % bucket_count;
         }
 
     public:
         // 构造函数
-        map(size_t initial_bucket_count = 16) 
-            : bucket_count(initial_bucket_count), num_elements(0) {
+        map(size_t initial_bucket_count = 16,
+            const Hash& hash_fn = Hash(), const KeyEqual& equal = KeyEqual())
+            : num_elements(0), bucket_count(initial_bucket_count), hasher(hash_fn), key_equal(equal) {
             table.resize(bucket_count);
         }
 
@@ -36,7 +42,7 @@ namespace kad {
 
             // 查找是否已存在相同的键
             for (auto& pair : bucket) {
-                if (pair.first == key) {
+                if (key_equal(pair.first, key)) {
                     pair.second = value; // 更新值
                     return;
                 }
@@ -53,7 +59,7 @@ namespace kad {
             auto& bucket = table[index];
 
             for (auto& pair : bucket) {
-                if (pair.first == key) {
+                if (key_equal(pair.first, key)) {
                     return &pair.second;
                 }
             }
@@ -67,7 +73,7 @@ namespace kad {
             auto& bucket = table[index];
 
             for (auto it = bucket.begin(); it != bucket.end(); ++it) {
-                if (it->first == key) {
+                if (key_equal(it->first, key)) {
                     bucket.erase(it);
                     --num_elements;
                     return;
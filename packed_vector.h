@@ -0,0 +1,316 @@
+#ifndef PACKED_VECTOR_H
+#define PACKED_VECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include "vector.h"
+
+namespace kad
+{
+    // 表示 v 所需的最少位数
+    inline unsigned bit_width(uint64_t v)
+    {
+        unsigned w = 0;
+        while (v)
+        {
+            ++w;
+            v >>= 1;
+        }
+        return w;
+    }
+
+    inline uint64_t low_mask(unsigned width)
+    {
+        return width >= 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+    }
+
+    // 从 words 的第 bit 位开始读出 width 位。words 末尾必须多留一个字，
+    // 这样跨字读取不需要分支
+    inline uint64_t read_bits(const uint64_t *words, size_t bit, uint64_t mask)
+    {
+        size_t word = bit >> 6;
+        unsigned off = bit & 63;
+        uint64_t lo = words[word] >> off;
+        uint64_t hi = (words[word + 1] << 1) << (63 - off);
+        return (lo | hi) & mask;
+    }
+
+    inline void write_bits(uint64_t *words, size_t bit, unsigned width, uint64_t value)
+    {
+        if (width == 0)
+        {
+            return;
+        }
+        size_t word = bit >> 6;
+        unsigned off = bit & 63;
+        uint64_t mask = low_mask(width);
+        words[word] = (words[word] & ~(mask << off)) | (value << off);
+        if (off + width > 64)
+        {
+            unsigned spill = 64 - off;
+            words[word + 1] = (words[word + 1] & ~(mask >> spill)) | (value >> spill);
+        }
+    }
+
+    // 固定位宽的整数数组：每个元素占 width 位，紧密排列在 64 位字里
+    class packed_vector
+    {
+    private:
+        vector<uint64_t> words_; // 总比实际需要多一个字
+        size_t size_;
+        unsigned width_;
+        uint64_t mask_;
+
+        void ensure_words(size_t n)
+        {
+            size_t needed = (n * width_ + 63) / 64 + 1;
+            while (words_.size() < needed)
+            {
+                words_.push_back(0);
+            }
+        }
+
+    public:
+        explicit packed_vector(unsigned width = 64)
+            : size_(0), width_(width), mask_(low_mask(width))
+        {
+            if (width > 64)
+            {
+                throw std::out_of_range("packed_vector: bit width must be at most 64");
+            }
+            ensure_words(0);
+        }
+
+        // 按最大值自动选择位宽后批量构建
+        static packed_vector build(const uint64_t *values, size_t n)
+        {
+            uint64_t max_value = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                max_value |= values[i];
+            }
+            packed_vector result(bit_width(max_value));
+            result.words_.reserve((n * result.width_ + 63) / 64 + 1);
+            result.ensure_words(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                write_bits(result.words_.data(), i * result.width_, result.width_, values[i]);
+            }
+            result.size_ = n;
+            return result;
+        }
+
+        uint64_t get(size_t i) const
+        {
+            return read_bits(words_.data(), i * width_, mask_);
+        }
+
+        uint64_t operator[](size_t i) const
+        {
+            return get(i);
+        }
+
+        void set(size_t i, uint64_t value)
+        {
+            if (value & ~mask_)
+            {
+                throw std::out_of_range("packed_vector::set(): value does not fit in bit width");
+            }
+            write_bits(words_.data(), i * width_, width_, value);
+        }
+
+        void push_back(uint64_t value)
+        {
+            if (value & ~mask_)
+            {
+                throw std::out_of_range("packed_vector::push_back(): value does not fit in bit width");
+            }
+            ensure_words(size_ + 1);
+            write_bits(words_.data(), size_ * width_, width_, value);
+            ++size_;
+        }
+
+        size_t size() const { return size_; }
+
+        bool empty() const { return size_ == 0; }
+
+        unsigned width() const { return width_; }
+
+        size_t memory_bytes() const { return words_.size() * sizeof(uint64_t); }
+    };
+
+    // 分块编码的整数数组：每 128 个值一块，块内用帧参考编码（减去块内最小值后按最小位宽打包）。
+    // delta 模式下先对相邻值做差再编码，适合递增的 id 和时间戳。
+    // 最后不满一块的值以原样缓存在尾部
+    class block_vector
+    {
+    public:
+        static const size_t block_size = 128;
+
+    private:
+        struct block_header
+        {
+            uint64_t base;   // 块内最小值（delta 模式下为最小差值）
+            uint64_t first;  // delta 模式下块的第一个原始值
+            size_t offset;   // 数据在 words_ 中的起始字
+            unsigned width;
+        };
+
+        vector<uint64_t> words_;
+        vector<block_header> headers_;
+        uint64_t tail_[block_size];
+        size_t tail_size_;
+        bool delta_;
+
+        // 位宽在编译期已知，循环里的移位都是常量，便于编译器向量化
+        template <unsigned W>
+        static void unpack(const uint64_t *words, uint64_t base, uint64_t *out)
+        {
+            const uint64_t mask = low_mask(W);
+            for (size_t j = 0; j < block_size; ++j)
+            {
+                out[j] = base + (W ? read_bits(words, j * W, mask) : 0);
+            }
+        }
+
+        typedef void (*unpack_fn)(const uint64_t *, uint64_t, uint64_t *);
+
+        template <unsigned... W>
+        struct unpack_table
+        {
+            static unpack_fn get(unsigned width)
+            {
+                static const unpack_fn table[] = {&block_vector::unpack<W>...};
+                return table[width];
+            }
+        };
+
+        template <unsigned N, unsigned... W>
+        struct make_table : make_table<N - 1, N - 1, W...>
+        {
+        };
+
+        template <unsigned... W>
+        struct make_table<0, W...>
+        {
+            typedef unpack_table<W...> type;
+        };
+
+        static unpack_fn unpacker(unsigned width)
+        {
+            return make_table<65>::type::get(width);
+        }
+
+        // 把尾部缓存编码成一个完整的块
+        void flush_tail()
+        {
+            uint64_t values[block_size];
+            block_header header;
+            header.first = tail_[0];
+            for (size_t j = 0; j < block_size; ++j)
+            {
+                values[j] = delta_ ? tail_[j] - (j ? tail_[j - 1] : tail_[0]) : tail_[j];
+            }
+            // delta 模式下 values[0] 恒为 0，第一个值已存在 header.first 里，不参与帧参考
+            size_t start = delta_ ? 1 : 0;
+            uint64_t lo = values[start], hi = values[start];
+            for (size_t j = start + 1; j < block_size; ++j)
+            {
+                lo = values[j] < lo ? values[j] : lo;
+                hi = values[j] > hi ? values[j] : hi;
+            }
+            header.base = lo;
+            header.width = bit_width(hi - lo);
+            header.offset = words_.empty() ? 0 : words_.size() - 1; // 复用上一块末尾的填充字
+
+            size_t words = (block_size * header.width + 63) / 64 + 1;
+            while (words_.size() < header.offset + words)
+            {
+                words_.push_back(0);
+            }
+            for (size_t j = start; j < block_size; ++j)
+            {
+                write_bits(words_.data() + header.offset, j * header.width, header.width, values[j] - lo);
+            }
+            headers_.push_back(header);
+            tail_size_ = 0;
+        }
+
+        // 解码第 b 块到 out
+        void decode_block(size_t b, uint64_t *out) const
+        {
+            const block_header &header = headers_.data()[b];
+            unpacker(header.width)(words_.data() + header.offset, header.base, out);
+            if (delta_)
+            {
+                out[0] = header.first; // 第 0 个槽位未编码，覆盖解出的 base
+                for (size_t j = 1; j < block_size; ++j)
+                {
+                    out[j] += out[j - 1];
+                }
+            }
+        }
+
+    public:
+        explicit block_vector(bool delta = false) : tail_size_(0), delta_(delta) {}
+
+        void push_back(uint64_t value)
+        {
+            tail_[tail_size_++] = value;
+            if (tail_size_ == block_size)
+            {
+                flush_tail();
+            }
+        }
+
+        // 随机访问：帧参考模式 O(1)；delta 模式需要解码所在的块
+        uint64_t get(size_t i) const
+        {
+            size_t b = i / block_size;
+            size_t j = i % block_size;
+            if (b == headers_.size())
+            {
+                return tail_[j];
+            }
+            if (delta_)
+            {
+                uint64_t out[block_size];
+                decode_block(b, out);
+                return out[j];
+            }
+            const block_header &header = headers_.data()[b];
+            return header.base + read_bits(words_.data() + header.offset, j * header.width, low_mask(header.width));
+        }
+
+        // 批量解码全部元素，追加到 out
+        void decode(vector<uint64_t> &out) const
+        {
+            out.reserve(out.size() + size());
+            uint64_t buffer[block_size];
+            for (size_t b = 0; b < headers_.size(); ++b)
+            {
+                decode_block(b, buffer);
+                for (size_t j = 0; j < block_size; ++j)
+                {
+                    out.push_back(buffer[j]);
+                }
+            }
+            for (size_t j = 0; j < tail_size_; ++j)
+            {
+                out.push_back(tail_[j]);
+            }
+        }
+
+        size_t size() const { return headers_.size() * block_size + tail_size_; }
+
+        bool empty() const { return size() == 0; }
+
+        size_t memory_bytes() const
+        {
+            return words_.size() * sizeof(uint64_t) + headers_.size() * sizeof(block_header) + sizeof(tail_);
+        }
+    };
+}
+
+#endif // PACKED_VECTOR_H
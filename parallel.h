@@ -0,0 +1,75 @@
+#ifndef KAD_PARALLEL_H
+#define KAD_PARALLEL_H
+
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <new>          // for std::bad_alloc
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace kad
+{
+    // 多线程容器操作（unordered_map::rehash_parallel、parallel_sort 等）共用的线程工具
+    namespace parallel_detail
+    {
+        inline size_t default_threads()
+        {
+            size_t n = std::thread::hardware_concurrency();
+            return n ? n : 1;
+        }
+
+        // 在 threads 个线程上执行 fn(0) ... fn(threads - 1)，当前线程执行最后一个。
+        // 任务抛出的异常在工作线程内捕获，全部任务结束后在调用线程重新抛出第一个；
+        // 线程创建失败时该任务改在当前线程执行，不会留下未 join 的线程
+        template <typename Fn>
+        void run_parallel(size_t threads, Fn fn)
+        {
+            std::exception_ptr error;
+            std::mutex error_mutex;
+            auto task = [&](size_t t) {
+                try
+                {
+                    fn(t);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+            };
+
+            std::vector<std::thread> workers;
+            for (size_t t = 0; t + 1 < threads; ++t)
+            {
+                try
+                {
+                    workers.emplace_back(task, t);
+                }
+                catch (const std::system_error &)
+                {
+                    task(t);
+                }
+                catch (const std::bad_alloc &)
+                {
+                    task(t);
+                }
+            }
+            task(threads - 1);
+            for (auto &w : workers)
+            {
+                w.join();
+            }
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+}
+
+#endif // KAD_PARALLEL_H
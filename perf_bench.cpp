@@ -0,0 +1,47 @@
+#include <cstdlib>
+#include <iostream>
+#include "perf_counter.h"
+#include "unordered_map.h"
+#include "vector.h"
+
+// 容器热点操作的硬件计数器基准，例如：./perf_bench 1000000
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+    kad::perf_counters pc;
+    if (!pc.available())
+    {
+        std::cerr << "perf counters unavailable, reporting wall time only" << std::endl;
+    }
+
+    {
+        kad::vector<size_t> vec;
+        KAD_PERF_REGION(pc, "vector::push_back", n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            vec.push_back(i);
+        }
+    }
+
+    kad::unordered_map<size_t, size_t> umap;
+    {
+        KAD_PERF_REGION(pc, "unordered_map::insert", n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            umap.insert(i * 7, i);
+        }
+    }
+
+    size_t hits = 0;
+    {
+        KAD_PERF_REGION(pc, "unordered_map::contains", n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            hits += umap.contains(i * 3);
+        }
+    }
+
+    std::cout << "hits: " << hits << std::endl;
+    return 0;
+}
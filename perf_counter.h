@@ -0,0 +1,271 @@
+#ifndef PERF_COUNTER_H
+#define PERF_COUNTER_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace kad
+{
+    // 采集的硬件事件
+    enum perf_event_kind
+    {
+        perf_cycles,
+        perf_instructions,
+        perf_l1d_misses,
+        perf_llc_misses,
+        perf_branch_misses,
+        perf_dtlb_misses,
+        perf_event_count
+    };
+
+    inline const char *perf_event_name(int kind)
+    {
+        static const char *names[perf_event_count] = {
+            "cycles", "instructions", "L1d-misses", "LLC-misses", "branch-misses", "dTLB-misses"};
+        return names[kind];
+    }
+
+    // 一次测量的结果；valid[i] 为 false 表示该计数器不可用（无权限、虚拟机不支持等）
+    struct perf_sample
+    {
+        uint64_t values[perf_event_count] = {};
+        bool valid[perf_event_count] = {};
+        double seconds = 0.0;
+
+        // 按操作次数归一化后输出
+        void print(std::ostream &os, const char *name, uint64_t ops = 1) const
+        {
+            if (ops == 0)
+            {
+                ops = 1;
+            }
+            // 只在本次输出里使用定点两位小数，结束后恢复调用者的流格式
+            std::ios_base::fmtflags flags = os.flags();
+            std::streamsize precision = os.precision();
+            os << name << " (" << ops << " ops): "
+               << std::fixed << std::setprecision(2)
+               << seconds * 1e9 / ops << " ns/op";
+            for (int i = 0; i < perf_event_count; ++i)
+            {
+                if (valid[i])
+                {
+                    os << ", " << perf_event_name(i) << "/op " << static_cast<double>(values[i]) / ops;
+                }
+            }
+            if (valid[perf_cycles] && valid[perf_instructions] && values[perf_cycles])
+            {
+                os << ", IPC " << static_cast<double>(values[perf_instructions]) / values[perf_cycles];
+            }
+            os.flags(flags);
+            os.precision(precision);
+            os << std::endl;
+        }
+    };
+
+    // perf_event_open 的封装，只统计当前线程的用户态事件。
+    // 所有计数器打开为一个事件组（第一个打开成功的事件作组长，通常是 cycles），
+    // 由组长统一复位、启停，一次 read 读出全部值，各计数器覆盖的区间完全相同，
+    // 被复用时也整组一起调度，比值（如 IPC）不会因各自的放大系数不同而失真。
+    // 计数器打不开时自动退化为只计时
+    class perf_counters
+    {
+    private:
+        int fds[perf_event_count];
+        int members[perf_event_count]; // 按加入事件组的顺序排列的事件，members[0] 为组长
+        int num_members;
+        std::chrono::steady_clock::time_point start_time;
+        perf_sample last;
+
+#if defined(__linux__)
+        int leader() const
+        {
+            return num_members ? fds[members[0]] : -1;
+        }
+
+        // 打开一个事件；组长创建时处于停止状态，其余成员跟随组长启停
+        void open_event(int kind, uint32_t type, uint64_t config)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = num_members == 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader(), 0));
+            if (fd >= 0)
+            {
+                fds[kind] = fd;
+                members[num_members++] = kind;
+            }
+        }
+
+        // 读出整组：nr、time_enabled、time_running，随后按加入顺序是各成员的值
+        bool read_group(uint64_t (&data)[3 + perf_event_count]) const
+        {
+            ssize_t expected = static_cast<ssize_t>(sizeof(uint64_t) * (3 + num_members));
+            return read(leader(), data, sizeof(data)) == expected && data[0] == uint64_t(num_members);
+        }
+
+        // 整组放不进 PMU 时内核根本不会调度它（time_running 始终为 0），
+        // 试运行一次，不行就从最后加入的成员开始逐个去掉
+        void fit_group()
+        {
+            while (num_members > 1)
+            {
+                ioctl(leader(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(leader(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+                for (volatile int spin = 0; spin < 1000; ++spin)
+                {
+                }
+                ioctl(leader(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+                uint64_t data[3 + perf_event_count];
+                if (read_group(data) && data[2] != 0)
+                {
+                    return;
+                }
+                int kind = members[--num_members];
+                close(fds[kind]);
+                fds[kind] = -1;
+            }
+        }
+
+        static uint64_t cache_config(uint64_t cache, uint64_t op, uint64_t result)
+        {
+            return cache | (op << 8) | (result << 16);
+        }
+#endif
+
+    public:
+        perf_counters() : num_members(0)
+        {
+            for (int i = 0; i < perf_event_count; ++i)
+            {
+                fds[i] = -1;
+            }
+#if defined(__linux__)
+            open_event(perf_cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+            open_event(perf_instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            open_event(perf_l1d_misses, PERF_TYPE_HW_CACHE,
+                       cache_config(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                    PERF_COUNT_HW_CACHE_RESULT_MISS));
+            open_event(perf_llc_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+            open_event(perf_branch_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+            open_event(perf_dtlb_misses, PERF_TYPE_HW_CACHE,
+                       cache_config(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                                    PERF_COUNT_HW_CACHE_RESULT_MISS));
+            fit_group();
+#endif
+        }
+
+        ~perf_counters()
+        {
+#if defined(__linux__)
+            // 先关成员，最后关组长
+            while (num_members > 0)
+            {
+                close(fds[members[--num_members]]);
+            }
+#endif
+        }
+
+        perf_counters(const perf_counters &) = delete;
+        perf_counters &operator=(const perf_counters &) = delete;
+
+        // 是否至少有一个硬件计数器可用
+        bool available() const
+        {
+            return num_members > 0;
+        }
+
+        void start()
+        {
+#if defined(__linux__)
+            if (num_members)
+            {
+                ioctl(leader(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(leader(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+#endif
+            start_time = std::chrono::steady_clock::now();
+        }
+
+        const perf_sample &stop()
+        {
+            auto end_time = std::chrono::steady_clock::now();
+            last = perf_sample();
+            last.seconds = std::chrono::duration<double>(end_time - start_time).count();
+#if defined(__linux__)
+            if (!num_members)
+            {
+                return last;
+            }
+            ioctl(leader(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            uint64_t data[3 + perf_event_count];
+            if (!read_group(data) || data[2] == 0)
+            {
+                return last;
+            }
+            // 事件组被复用时按实际运行时间比例放大，整组共用一个系数
+            double scale = static_cast<double>(data[1]) / data[2];
+            for (int j = 0; j < num_members; ++j)
+            {
+                last.values[members[j]] = static_cast<uint64_t>(data[3 + j] * scale);
+                last.valid[members[j]] = true;
+            }
+#endif
+            return last;
+        }
+
+        const perf_sample &sample() const
+        {
+            return last;
+        }
+    };
+
+    // 作用域内测量，析构时按 ops 归一化后输出
+    class perf_region
+    {
+    private:
+        perf_counters &counters;
+        const char *name;
+        uint64_t ops;
+        std::ostream &os;
+
+    public:
+        perf_region(perf_counters &pc, const char *region_name, uint64_t op_count = 1,
+                    std::ostream &out = std::cerr)
+            : counters(pc), name(region_name), ops(op_count), os(out)
+        {
+            counters.start();
+        }
+
+        ~perf_region()
+        {
+            counters.stop().print(os, name, ops);
+        }
+
+        perf_region(const perf_region &) = delete;
+        perf_region &operator=(const perf_region &) = delete;
+    };
+}
+
+// 测量当前作用域，例如 KAD_PERF_REGION(pc, "unordered_map::insert", n);
+#define KAD_PERF_CONCAT_IMPL(a, b) a##b
+#define KAD_PERF_CONCAT(a, b) KAD_PERF_CONCAT_IMPL(a, b)
+#define KAD_PERF_REGION(counters, name, ops) \
+    kad::perf_region KAD_PERF_CONCAT(kad_perf_region_, __LINE__)(counters, name, ops)
+
+#endif // PERF_COUNTER_H
@@ -0,0 +1,281 @@
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include "allocator.h"
+#include "config.h"
+#include "iterator.h"
+#include <stdexcept>
+namespace kad
+{
+    // 前 N 个元素存放在对象内部的缓冲区，超过 N 个时才通过 alloc 在堆上分配。
+    // 接口和迭代器类型与 kad::vector 相同。
+    template <typename T, size_t N, typename alloc = kad::allocator<T>>
+    class small_vector
+    {
+        static_assert(N > 0, "small_vector: N must be positive, use kad::vector instead");
+
+    public:
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+        using value_type = T;
+
+    private:
+        /* data */
+        value_type *data_;
+        size_type size_;
+        size_type capacity_;
+        alloc allocator_;
+        alignas(T) unsigned char inline_[N * sizeof(T)];
+
+        value_type *inline_data()
+        {
+            return reinterpret_cast<value_type *>(inline_);
+        }
+
+        // 把元素搬到容量为 new_capacity 的新堆内存。append 非空时先在新内存末尾构造它，
+        // 再搬迁旧元素，所以 append 可以指向本容器内的元素
+        void grow(size_type new_capacity, const value_type *append = nullptr);
+
+        void destroy_all();
+
+        // 接管 vec 的元素，调用前 *this 必须为空且使用内部缓冲区。
+        // vec 在堆上时直接拿走指针，否则逐个移动；之后 vec 为空并回到内部缓冲区
+        void take(small_vector &vec);
+
+    public:
+        small_vector();
+        small_vector(size_type n);
+        small_vector(size_type n, T val);
+        small_vector(const small_vector &vec);
+        small_vector(small_vector &&vec);
+        ~small_vector();
+
+        small_vector &operator=(const small_vector &vec);
+        small_vector &operator=(small_vector &&vec);
+
+    public:
+        // 返回指向首个元素的迭代器
+        iterator<T> begin() { return iterator<T>(data_); }
+        // 返回尾后迭代器
+        iterator<T> end() { return iterator<T>(data_ + size_); }
+        void push_back(const value_type &value);
+        void pop_back();
+        void clear();
+        size_t size() const { return size_; }
+        size_t capacity() const { return capacity_; }
+        bool empty() const { return size_ == 0; }
+        value_type *data() const { return data_; }
+
+        // 元素是否仍在内部缓冲区中（未分配堆内存）
+        bool is_inline() const { return data_ == reinterpret_cast<const value_type *>(inline_); }
+
+        T &back();
+        T &front();
+
+        T &operator[](size_t i)
+        {
+            KAD_CHECK_BOUNDS(i < size_, "small_vector::operator[]: index out of range");
+            return *(data_ + i);
+        }
+    };
+
+    template <typename T, size_t N, typename alloc>
+    small_vector<T, N, alloc>::small_vector()
+        : data_(inline_data()), size_(0), capacity_(N), allocator_()
+    {
+    }
+
+    template <typename T, size_t N, typename alloc>
+    small_vector<T, N, alloc>::small_vector(size_type n)
+        : small_vector()
+    {
+        if (n > capacity_)
+        {
+            grow(n);
+        }
+        for (size_type i = 0; i < n; ++i)
+        {
+            allocator_.construct(data_ + i, T());
+            ++size_;
+        }
+    }
+
+    template <typename T, size_t N, typename alloc>
+    small_vector<T, N, alloc>::small_vector(size_type n, T val)
+        : small_vector()
+    {
+        for (size_type i = 0; i < n; ++i)
+        {
+            push_back(val);
+        }
+    }
+
+    template <typename T, size_t N, typename alloc>
+    small_vector<T, N, alloc>::small_vector(const small_vector &vec)
+        : small_vector()
+    {
+        *this = vec;
+    }
+
+    template <typename T, size_t N, typename alloc>
+    small_vector<T, N, alloc>::small_vector(small_vector &&vec)
+        : small_vector()
+    {
+        take(vec);
+    }
+
+    template <typename T, size_t N, typename alloc>
+    void small_vector<T, N, alloc>::take(small_vector &vec)
+    {
+        if (!vec.is_inline())
+        {
+            data_ = vec.data_;
+            size_ = vec.size_;
+            capacity_ = vec.capacity_;
+            vec.data_ = vec.inline_data();
+            vec.size_ = 0;
+            vec.capacity_ = N;
+            return;
+        }
+        for (size_type i = 0; i < vec.size_; ++i)
+        {
+            allocator_.construct(data_ + i, static_cast<value_type &&>(vec.data_[i]));
+            ++size_;
+        }
+        vec.clear();
+    }
+
+    template <typename T, size_t N, typename alloc>
+    small_vector<T, N, alloc> &small_vector<T, N, alloc>::operator=(small_vector &&vec)
+    {
+        if (this == &vec)
+        {
+            return *this;
+        }
+        clear();
+        if (!is_inline())
+        {
+            allocator_.deallocate(data_, capacity_);
+            data_ = inline_data();
+            capacity_ = N;
+        }
+        take(vec);
+        return *this;
+    }
+
+    template <typename T, size_t N, typename alloc>
+    small_vector<T, N, alloc> &small_vector<T, N, alloc>::operator=(const small_vector &vec)
+    {
+        if (this == &vec)
+        {
+            return *this;
+        }
+        clear();
+        if (vec.size_ > capacity_)
+        {
+            grow(vec.size_);
+        }
+        for (size_type i = 0; i < vec.size_; ++i)
+        {
+            allocator_.construct(data_ + i, vec.data_[i]);
+        }
+        size_ = vec.size_;
+        return *this;
+    }
+
+    template <typename T, size_t N, typename alloc>
+    small_vector<T, N, alloc>::~small_vector()
+    {
+        destroy_all();
+        if (!is_inline())
+        {
+            allocator_.deallocate(data_, capacity_);
+        }
+    }
+
+    template <typename T, size_t N, typename alloc>
+    void small_vector<T, N, alloc>::destroy_all()
+    {
+        for (size_type i = 0; i < size_; ++i)
+        {
+            allocator_.destroy(data_ + i);
+        }
+    }
+
+    template <typename T, size_t N, typename alloc>
+    void small_vector<T, N, alloc>::grow(size_type new_capacity, const value_type *append)
+    {
+        value_type *new_data = allocator_.allocate(new_capacity);
+        if (append)
+        {
+            try
+            {
+                allocator_.construct(new_data + size_, *append);
+            }
+            catch (...)
+            {
+                allocator_.deallocate(new_data, new_capacity);
+                throw;
+            }
+        }
+        for (size_type i = 0; i < size_; ++i)
+        {
+            allocator_.construct(new_data + i, static_cast<value_type &&>(data_[i]));
+        }
+        destroy_all();
+        if (!is_inline())
+        {
+            allocator_.deallocate(data_, capacity_);
+        }
+        data_ = new_data;
+        capacity_ = new_capacity;
+    }
+
+    template <typename T, size_t N, typename alloc>
+    void small_vector<T, N, alloc>::push_back(const value_type &value)
+    {
+        if (size_ == capacity_)
+        {
+            // 内部缓冲区用完后转到堆上，之后按翻倍增长；value 可能引用旧元素，先构造新元素
+            grow(capacity_ ? capacity_ * 2 : 4, &value);
+        }
+        else
+        {
+            allocator_.construct(data_ + size_, value);
+        }
+        ++size_;
+    }
+
+    template <typename T, size_t N, typename alloc>
+    void small_vector<T, N, alloc>::pop_back()
+    {
+        KAD_CHECK_BOUNDS(size_ != 0, "small_vector::pop_back(): empty vector");
+        --size_;
+        allocator_.destroy(data_ + size_);
+    }
+
+    template <typename T, size_t N, typename alloc>
+    void small_vector<T, N, alloc>::clear()
+    {
+        destroy_all();
+        size_ = 0;
+    }
+
+    template <typename T, size_t N, typename alloc>
+    T &small_vector<T, N, alloc>::front()
+    {
+        KAD_CHECK_BOUNDS(size_ != 0, "small_vector::front(): empty vector");
+
+        return data_[0];
+    }
+
+    template <typename T, size_t N, typename alloc>
+    T &small_vector<T, N, alloc>::back()
+    {
+        KAD_CHECK_BOUNDS(size_ != 0, "small_vector::back(): empty vector");
+
+        return data_[size_ - 1];
+    }
+}
+
+#endif
@@ -0,0 +1,595 @@
+#ifndef KAD_SORT_H
+#define KAD_SORT_H
+
+#include <algorithm>   // for std::make_heap, std::sort_heap, std::inplace_merge, std::stable_sort
+#include <cstddef>
+#include <cstdint>
+#include <cstring>     // for std::memcpy, std::strcmp
+#include <functional>  // for std::less
+#include <type_traits>
+#include <utility>     // for std::move, std::swap
+#include <vector>
+#include "parallel.h"
+#include "string.h"
+#include "vector.h"
+
+namespace kad
+{
+    namespace sort_detail
+    {
+        // 少于这么多元素时直接插入排序
+        const size_t insertion_threshold = 24;
+        // 少于这么多元素时基数排序不划算
+        const size_t radix_threshold = 256;
+
+        template <typename T>
+        struct is_basechar : std::false_type
+        {
+        };
+
+        template <typename T, typename alloc>
+        struct is_basechar<basechar<T, alloc>> : std::true_type
+        {
+        };
+
+        // 整数和浮点数映射到无符号整数，映射后的大小顺序与原值一致
+        template <typename T>
+        struct radix_traits
+        {
+            using key_type = typename std::conditional<sizeof(T) <= 4,
+                                                       typename std::conditional<sizeof(T) <= 2,
+                                                                                 typename std::conditional<sizeof(T) == 1, uint8_t, uint16_t>::type,
+                                                                                 uint32_t>::type,
+                                                       uint64_t>::type;
+
+            static key_type to_key(T value)
+            {
+                key_type bits = 0;
+                std::memcpy(&bits, &value, sizeof(T));
+                const key_type sign = key_type(1) << (sizeof(T) * 8 - 1);
+                if (std::is_floating_point<T>::value)
+                {
+                    // 负数全部取反，非负数只翻转符号位
+                    return (bits & sign) ? key_type(~bits) : key_type(bits | sign);
+                }
+                if (std::is_signed<T>::value)
+                {
+                    return key_type(bits ^ sign);
+                }
+                return bits;
+            }
+        };
+
+        template <typename T>
+        struct is_radix_sortable
+            : std::integral_constant<bool, (std::is_integral<T>::value || std::is_floating_point<T>::value) &&
+                                               !std::is_same<T, bool>::value && sizeof(T) <= 8 &&
+                                               (!std::is_floating_point<T>::value || sizeof(T) == 4 || sizeof(T) == 8)>
+        {
+        };
+
+        // LSD 基数排序，每趟按 8 位分桶，稳定。所有元素某一字节都相同时跳过这一趟。
+        // key(rec) 返回无符号整数
+        template <typename Rec, typename Key>
+        void lsd_radix_sort(Rec *first, size_t n, Key key)
+        {
+            using key_type = decltype(key(*first));
+            const size_t passes = sizeof(key_type);
+            std::vector<size_t> counts(passes * 256, 0);
+            for (size_t i = 0; i < n; ++i)
+            {
+                key_type k = key(first[i]);
+                for (size_t p = 0; p < passes; ++p)
+                {
+                    ++counts[p * 256 + ((k >> (p * 8)) & 0xFF)];
+                }
+            }
+
+            std::vector<Rec> buffer(n);
+            Rec *src = first;
+            Rec *dst = buffer.data();
+            bool in_buffer = false; // 当前有效数据是否在 buffer 中
+            for (size_t p = 0; p < passes; ++p)
+            {
+                size_t *count = &counts[p * 256];
+                bool trivial = false;
+                for (size_t b = 0; b < 256; ++b)
+                {
+                    if (count[b] == n)
+                    {
+                        trivial = true;
+                    }
+                }
+                if (trivial)
+                {
+                    continue;
+                }
+                size_t offset = 0;
+                for (size_t b = 0; b < 256; ++b)
+                {
+                    size_t c = count[b];
+                    count[b] = offset;
+                    offset += c;
+                }
+                for (size_t i = 0; i < n; ++i)
+                {
+                    dst[count[(key(src[i]) >> (p * 8)) & 0xFF]++] = std::move(src[i]);
+                }
+                std::swap(src, dst);
+                in_buffer = !in_buffer;
+            }
+            if (in_buffer)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    first[i] = std::move(src[i]);
+                }
+            }
+        }
+
+        template <typename T, typename Compare>
+        void insertion_sort(T *first, T *last, Compare comp)
+        {
+            if (first == last)
+            {
+                return;
+            }
+            for (T *cur = first + 1; cur != last; ++cur)
+            {
+                if (comp(*cur, *(cur - 1)))
+                {
+                    T tmp = std::move(*cur);
+                    T *sift = cur;
+                    do
+                    {
+                        *sift = std::move(*(sift - 1));
+                        --sift;
+                    } while (sift != first && comp(tmp, *(sift - 1)));
+                    *sift = std::move(tmp);
+                }
+            }
+        }
+
+        // 插入排序，移动次数超过上限就放弃，返回是否已排好
+        template <typename T, typename Compare>
+        bool partial_insertion_sort(T *first, T *last, Compare comp)
+        {
+            const size_t limit = 8;
+            if (first == last)
+            {
+                return true;
+            }
+            size_t moves = 0;
+            for (T *cur = first + 1; cur != last; ++cur)
+            {
+                if (comp(*cur, *(cur - 1)))
+                {
+                    T tmp = std::move(*cur);
+                    T *sift = cur;
+                    do
+                    {
+                        *sift = std::move(*(sift - 1));
+                        --sift;
+                    } while (sift != first && comp(tmp, *(sift - 1)));
+                    *sift = std::move(tmp);
+                    moves += cur - sift;
+                    if (moves > limit)
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        template <typename T, typename Compare>
+        void sort2(T *a, T *b, Compare comp)
+        {
+            if (comp(*b, *a))
+            {
+                std::swap(*a, *b);
+            }
+        }
+
+        // 排序后中位数在 b
+        template <typename T, typename Compare>
+        void sort3(T *a, T *b, T *c, Compare comp)
+        {
+            sort2(a, b, comp);
+            sort2(b, c, comp);
+            sort2(a, b, comp);
+        }
+
+        // 以 *first 为枢轴划分，小于枢轴的在左边；返回枢轴最终位置，
+        // already_partitioned 表示划分前就已经有序（没有发生交换）
+        template <typename T, typename Compare>
+        T *partition_right(T *first, T *last, Compare comp, bool &already_partitioned)
+        {
+            T pivot = std::move(*first);
+            T *begin = first;
+            while (comp(*++first, pivot))
+            {
+            }
+            if (first - 1 == begin)
+            {
+                while (first < last && !comp(*--last, pivot))
+                {
+                }
+            }
+            else
+            {
+                while (!comp(*--last, pivot))
+                {
+                }
+            }
+            already_partitioned = first >= last;
+            while (first < last)
+            {
+                std::swap(*first, *last);
+                while (comp(*++first, pivot))
+                {
+                }
+                while (!comp(*--last, pivot))
+                {
+                }
+            }
+            T *pivot_pos = first - 1;
+            *begin = std::move(*pivot_pos);
+            *pivot_pos = std::move(pivot);
+            return pivot_pos;
+        }
+
+        // 与枢轴相等的元素放在左边，用于大量重复元素的区间
+        template <typename T, typename Compare>
+        T *partition_left(T *first, T *last, Compare comp)
+        {
+            T pivot = std::move(*first);
+            T *begin = first;
+            T *end = last;
+            while (comp(pivot, *--last))
+            {
+            }
+            if (last + 1 == end)
+            {
+                while (first < last && !comp(pivot, *++first))
+                {
+                }
+            }
+            else
+            {
+                while (!comp(pivot, *++first))
+                {
+                }
+            }
+            while (first < last)
+            {
+                std::swap(*first, *last);
+                while (comp(pivot, *--last))
+                {
+                }
+                while (!comp(pivot, *++first))
+                {
+                }
+            }
+            T *pivot_pos = last;
+            *begin = std::move(*pivot_pos);
+            *pivot_pos = std::move(pivot);
+            return pivot_pos;
+        }
+
+        // pattern-defeating quicksort：小区间插入排序，大区间取 ninther 作枢轴；
+        // 检测到已划分好的区间时尝试插入排序收尾，划分严重失衡时打乱，次数过多退化为堆排序
+        template <typename T, typename Compare>
+        void pdqsort_loop(T *first, T *last, Compare comp, int bad_allowed, bool leftmost)
+        {
+            while (true)
+            {
+                size_t size = last - first;
+                if (size < insertion_threshold)
+                {
+                    insertion_sort(first, last, comp);
+                    return;
+                }
+
+                size_t half = size / 2;
+                if (size > 128)
+                {
+                    sort3(first, first + half, last - 1, comp);
+                    sort3(first + 1, first + (half - 1), last - 2, comp);
+                    sort3(first + 2, first + (half + 1), last - 3, comp);
+                    sort3(first + (half - 1), first + half, first + (half + 1), comp);
+                    std::swap(*first, *(first + half));
+                }
+                else
+                {
+                    sort3(first + half, first, last - 1, comp);
+                }
+
+                // 枢轴与左边界外的元素相等：这一段全是重复元素，一次划分掉
+                if (!leftmost && !comp(*(first - 1), *first))
+                {
+                    first = partition_left(first, last, comp) + 1;
+                    continue;
+                }
+
+                bool already_partitioned = false;
+                T *pivot_pos = partition_right(first, last, comp, already_partitioned);
+                size_t left_size = pivot_pos - first;
+                size_t right_size = last - (pivot_pos + 1);
+
+                if (left_size < size / 8 || right_size < size / 8)
+                {
+                    if (--bad_allowed == 0)
+                    {
+                        std::make_heap(first, last, comp);
+                        std::sort_heap(first, last, comp);
+                        return;
+                    }
+                    if (left_size >= insertion_threshold)
+                    {
+                        std::swap(*first, *(first + left_size / 4));
+                        std::swap(*(pivot_pos - 1), *(pivot_pos - left_size / 4));
+                    }
+                    if (right_size >= insertion_threshold)
+                    {
+                        std::swap(*(pivot_pos + 1), *(pivot_pos + 1 + right_size / 4));
+                        std::swap(*(last - 1), *(last - right_size / 4));
+                    }
+                }
+                else if (already_partitioned &&
+                         partial_insertion_sort(first, pivot_pos, comp) &&
+                         partial_insertion_sort(pivot_pos + 1, last, comp))
+                {
+                    return;
+                }
+
+                pdqsort_loop(first, pivot_pos, comp, bad_allowed, leftmost);
+                first = pivot_pos + 1;
+                leftmost = false;
+            }
+        }
+
+        template <typename T, typename Compare>
+        void pdqsort(T *first, T *last, Compare comp)
+        {
+            size_t size = last - first;
+            int log2 = 0;
+            while (size >>= 1)
+            {
+                ++log2;
+            }
+            pdqsort_loop(first, last, comp, log2 + 1, true);
+        }
+
+        // 第 depth 个字符，越过结尾为 0
+        template <typename S>
+        unsigned char char_at(const S &s, size_t depth)
+        {
+            return static_cast<unsigned char>(s.c_str()[depth]);
+        }
+
+        // 多关键字快速排序（三路基数快排）：按第 depth 个字符三路划分，
+        // 相等的部分从下一个字符继续，已比较过的前缀不再重复比较
+        template <typename S>
+        void multikey_quicksort(S *first, size_t n, size_t depth)
+        {
+            while (n > 1)
+            {
+                if (n < insertion_threshold)
+                {
+                    insertion_sort(first, first + n, [depth](const S &a, const S &b) {
+                        return std::strcmp(a.c_str() + depth, b.c_str() + depth) < 0;
+                    });
+                    return;
+                }
+
+                unsigned char a = char_at(first[0], depth);
+                unsigned char b = char_at(first[n / 2], depth);
+                unsigned char c = char_at(first[n - 1], depth);
+                unsigned char pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+
+                size_t lt = 0, i = 0, gt = n;
+                while (i < gt)
+                {
+                    unsigned char ch = char_at(first[i], depth);
+                    if (ch < pivot)
+                    {
+                        std::swap(first[lt++], first[i++]);
+                    }
+                    else if (ch > pivot)
+                    {
+                        std::swap(first[i], first[--gt]);
+                    }
+                    else
+                    {
+                        ++i;
+                    }
+                }
+
+                multikey_quicksort(first, lt, depth);
+                multikey_quicksort(first + gt, n - gt, depth);
+                if (pivot == 0)
+                {
+                    return; // 相等部分的字符串已经全部结束
+                }
+                first += lt;
+                n = gt - lt;
+                ++depth;
+            }
+        }
+
+        // 与基数排序和多关键字快排一致的比较：基数排序类型比较映射后的键，basechar 按 strcmp，
+        // 其余用 operator<。各种规模、各条路径都用它，排序结果（包括 NaN 的位置）与规模无关
+        template <typename T, bool Radix = is_radix_sortable<T>::value, bool String = is_basechar<T>::value>
+        struct range_less : std::less<T>
+        {
+        };
+
+        template <typename T>
+        struct range_less<T, true, false>
+        {
+            bool operator()(const T &a, const T &b) const
+            {
+                return radix_traits<T>::to_key(a) < radix_traits<T>::to_key(b);
+            }
+        };
+
+        template <typename T>
+        struct range_less<T, false, true>
+        {
+            bool operator()(const T &a, const T &b) const
+            {
+                return std::strcmp(a.c_str(), b.c_str()) < 0;
+            }
+        };
+
+        // 按元素类型选择排序算法
+        template <typename T>
+        void sort_range(T *first, T *last, std::true_type /* radix */)
+        {
+            size_t n = last - first;
+            if (n < radix_threshold)
+            {
+                pdqsort(first, last, range_less<T>());
+                return;
+            }
+            using key_type = typename radix_traits<T>::key_type;
+            lsd_radix_sort(first, n, [](const T &value) -> key_type {
+                return radix_traits<T>::to_key(value);
+            });
+        }
+
+        template <typename T>
+        void sort_comparable(T *first, T *last, std::true_type /* basechar */)
+        {
+            multikey_quicksort(first, last - first, 0);
+        }
+
+        template <typename T>
+        void sort_comparable(T *first, T *last, std::false_type /* basechar */)
+        {
+            pdqsort(first, last, std::less<T>());
+        }
+
+        template <typename T>
+        void sort_range(T *first, T *last, std::false_type /* radix */)
+        {
+            sort_comparable(first, last, is_basechar<T>());
+        }
+
+        template <typename T>
+        void sort_range(T *first, T *last)
+        {
+            sort_range(first, last, is_radix_sortable<T>());
+        }
+
+        template <typename T, typename KeyFn>
+        void sort_by_key(T *first, size_t n, KeyFn key, std::false_type /* radix */)
+        {
+            range_less<typename std::decay<decltype(key(*first))>::type> less;
+            std::stable_sort(first, first + n, [&key, &less](const T &a, const T &b) {
+                return less(key(a), key(b));
+            });
+        }
+
+        // 对 (键, 下标) 做基数排序，再按下标重排元素
+        template <typename T, typename KeyFn>
+        void sort_by_key(T *first, size_t n, KeyFn key, std::true_type /* radix */)
+        {
+            using traits = radix_traits<typename std::decay<decltype(key(*first))>::type>;
+            using key_type = typename traits::key_type;
+            if (n < radix_threshold)
+            {
+                range_less<typename std::decay<decltype(key(*first))>::type> less;
+                std::stable_sort(first, first + n, [&key, &less](const T &a, const T &b) {
+                    return less(key(a), key(b));
+                });
+                return;
+            }
+
+            std::vector<std::pair<key_type, size_t>> order(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                order[i] = std::make_pair(traits::to_key(key(first[i])), i);
+            }
+            lsd_radix_sort(order.data(), n, [](const std::pair<key_type, size_t> &e) {
+                return e.first;
+            });
+
+            std::vector<T> sorted;
+            sorted.reserve(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                sorted.push_back(std::move(first[order[i].second]));
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                first[i] = std::move(sorted[i]);
+            }
+        }
+    }
+
+    // 排序 vector：整数和浮点数用 LSD 基数排序，kad::basechar 用多关键字快速排序，
+    // 其它类型用 pdqsort
+    template <typename T, typename alloc>
+    void sort(vector<T, alloc> &vec)
+    {
+        sort_detail::sort_range(vec.data(), vec.data() + vec.size());
+    }
+
+    // 使用自定义比较函数，总是 pdqsort
+    template <typename T, typename alloc, typename Compare>
+    void sort(vector<T, alloc> &vec, Compare comp)
+    {
+        sort_detail::pdqsort(vec.data(), vec.data() + vec.size(), comp);
+    }
+
+    // 按 key(element) 提取的字段稳定排序。字段是整数或浮点数时用基数排序，否则用 std::stable_sort
+    template <typename T, typename alloc, typename KeyFn>
+    void sort_by_key(vector<T, alloc> &vec, KeyFn key)
+    {
+        using key_value = typename std::decay<decltype(key(*vec.data()))>::type;
+        sort_detail::sort_by_key(vec.data(), vec.size(), key, sort_detail::is_radix_sortable<key_value>());
+    }
+
+    // 多线程排序：切成 threads 段分别排序，再两两归并
+    template <typename T, typename alloc>
+    void parallel_sort(vector<T, alloc> &vec, size_t threads = 0)
+    {
+        if (threads == 0)
+        {
+            threads = parallel_detail::default_threads();
+        }
+        T *first = vec.data();
+        size_t n = vec.size();
+        if (threads == 1 || n < threads * sort_detail::radix_threshold)
+        {
+            sort_detail::sort_range(first, first + n);
+            return;
+        }
+
+        std::vector<size_t> bounds(threads + 1);
+        for (size_t t = 0; t <= threads; ++t)
+        {
+            bounds[t] = n * t / threads;
+        }
+
+        parallel_detail::run_parallel(threads, [first, &bounds](size_t t) {
+            sort_detail::sort_range(first + bounds[t], first + bounds[t + 1]);
+        });
+
+        // 每轮把相邻的两段归并成一段，这一轮有 merges 次归并
+        for (size_t width = 1; width < threads; width *= 2)
+        {
+            size_t merges = (threads - width + width * 2 - 1) / (width * 2);
+            parallel_detail::run_parallel(merges, [first, &bounds, threads, width](size_t i) {
+                size_t t = i * width * 2;
+                size_t end = t + width * 2 < threads ? t + width * 2 : threads;
+                std::inplace_merge(first + bounds[t], first + bounds[t + width], first + bounds[end],
+                                   sort_detail::range_less<T>());
+            });
+        }
+    }
+}
+
+#endif // KAD_SORT_H
@@ -2,7 +2,13 @@
 #define KAD_STRING_H
 
 #include <cstring>  // for strlen, strcpy, strcat
+#include <functional> // for std::hash
 #include <iostream> // for std::ostream, std::istream
+#include <stdexcept> // for std::out_of_range
+#include "allocator.h"
+#include "config.h"
+#include "iterator.h"
+#include "hash.h"
 
 namespace kad
 {
@@ -14,17 +20,21 @@ namespace kad
         char *data; // 存储字符串的动态数组
         size_t len; // 字符串长度（不包括 '\0'）
         alloc allocator_;
+        mutable size_t hash_;       // 缓存的哈希值
+        mutable bool hash_valid_;   // 任何可能修改内容的操作都会使缓存失效
+
+        void invalidate_hash() { hash_valid_ = false; }
 
     public:
 
 
         // 默认构造函数
-        basechar() : data(allocator_.allocate(1)), len(0) {
+        basechar() : data(allocator_.allocate(1)), len(0), hash_(0), hash_valid_(false) {
             data[0]='\0';
         }
 
         // C 风格字符串构造
-        basechar(const char *str)
+        basechar(const char *str) : hash_(0), hash_valid_(false)
         {
             len = std::strlen(str);
             data = allocator_.allocate(len+1); // 分配内存
@@ -32,7 +42,7 @@ namespace kad
         }
 
         // 拷贝构造函数
-        basechar(const basechar &other)
+        basechar(const basechar &other) : hash_(other.hash_), hash_valid_(other.hash_valid_)
         {
             len = other.len;
             data = allocator_.allocate(len+1);
@@ -40,7 +50,8 @@ namespace kad
         }
 
         // 移动构造函数
-        basechar(basechar &&other) noexcept : data(other.data), len(other.len)
+        basechar(basechar &&other) noexcept
+            : data(other.data), len(other.len), hash_(other.hash_), hash_valid_(other.hash_valid_)
         {
             other.data = nullptr;
             other.len = 0;
@@ -61,6 +72,8 @@ namespace kad
             len = other.len;
             data = allocator_.allocate(len+1);
             std::strcpy(data, other.data);
+            hash_ = other.hash_;
+            hash_valid_ = other.hash_valid_;
             return *this;
         }
 
@@ -72,6 +85,8 @@ namespace kad
             allocator_.deallocate(data,len+1);
             data = other.data;
             len = other.len;
+            hash_ = other.hash_;
+            hash_valid_ = other.hash_valid_;
             other.data = nullptr;
             other.len = 0;
             return *this;
@@ -93,6 +108,7 @@ namespace kad
             allocator_.deallocate(data,len+1);
             data = new_data;
             len = new_len;
+            invalidate_hash();
         }
 
         // 清空字符串
@@ -102,18 +118,52 @@ namespace kad
             data = allocator_.allocate(1);
             data[0]='\0';
             len = 0;
+            invalidate_hash();
         }
 
         // 访问字符（支持修改）
-        char &operator[](size_t index) { return data[index]; }
+        char &operator[](size_t index)
+        {
+            KAD_CHECK_BOUNDS(index < len, "basechar::operator[]: index out of range");
+            invalidate_hash();
+            return data[index];
+        }
 
         // 访问字符（常量版本）
-        const char &operator[](size_t index) const { return data[index]; }
+        // 常量版本允许访问结尾的 '\0'
+        const char &operator[](size_t index) const
+        {
+            KAD_CHECK_BOUNDS(index <= len, "basechar::operator[]: index out of range");
+            return data[index];
+        }
 
-        // 字符串相等比较
+        // 字符串相等比较，不使用缓存的哈希值（缓存可能已过期，见 hash()）
         bool operator==(const basechar &other) const
         {
-            return std::strcmp(data, other.data) == 0;
+            if (len != other.len)
+                return false;
+            if (len == 0)
+                return true;
+            return std::memcmp(data, other.data, len) == 0;
+        }
+
+        bool operator!=(const basechar &other) const
+        {
+            return !(*this == other);
+        }
+
+        // 字符串的哈希值，第一次计算后缓存，修改内容后重新计算。
+        // 缓存只在调用成员函数时失效：在 hash() 之前取得的 char& 或迭代器，
+        // 之后再通过它修改内容不会使缓存失效，hash() 会返回旧值；相等比较不受影响。
+        // 缓存写在 mutable 成员里，多个线程同时对同一个对象首次调用需要外部同步
+        size_t hash() const
+        {
+            if (!hash_valid_)
+            {
+                hash_ = static_cast<size_t>(hash_bytes(data, len));
+                hash_valid_ = true;
+            }
+            return hash_;
         }
 
         // 拼接字符串
@@ -157,29 +207,29 @@ namespace kad
 
         // 返回指向string首个元素的迭代器
         iterator<T> begin(){
+            invalidate_hash();
             return iterator<T>(data);
 
         };
         // 返回指向string末尾元素之后位置的迭代器（尾后迭代器）
         iterator<T> end(){
+            invalidate_hash();
             return iterator<T>(data+len);
         };
 
     T& front() 
     {
-        if (len == 0) {
-            throw std::out_of_range("vector::back(): empty vector");
-        }
+        KAD_CHECK_BOUNDS(len != 0, "basechar::front(): empty string");
 
+        invalidate_hash();
         return data[0];
     }
 
     T& back() 
     {
-        if (len == 0) {
-            throw std::out_of_range("vector::back(): empty vector");
-        }
+        KAD_CHECK_BOUNDS(len != 0, "basechar::back(): empty string");
 
+        invalidate_hash();
         return data[len-1];
     }
 
@@ -190,6 +240,29 @@ namespace kad
 
     typedef basechar<> string;
 
+    // 用于哈希容器的哈希函数对象，直接使用字符串缓存的哈希值
+    struct string_hash
+    {
+        template <typename T, typename alloc>
+        size_t operator()(const basechar<T, alloc> &str) const
+        {
+            return str.hash();
+        }
+    };
+
 } // namespace kad
 
+// 让 kad::string 可以直接作为 std::hash 默认哈希的键
+namespace std
+{
+    template <typename T, typename alloc>
+    struct hash<kad::basechar<T, alloc>>
+    {
+        size_t operator()(const kad::basechar<T, alloc> &str) const
+        {
+            return str.hash();
+        }
+    };
+}
+
 #endif // KAD_STRING_H
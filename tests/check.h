@@ -0,0 +1,18 @@
+#ifndef KAD_TESTS_CHECK_H
+#define KAD_TESTS_CHECK_H
+
+#include <cstdio>
+#include <cstdlib>
+
+// 不受 NDEBUG 影响的断言，失败时打印位置并以非零码退出
+#define KAD_CHECK(cond)                                                          \
+    do                                                                           \
+    {                                                                            \
+        if (!(cond))                                                             \
+        {                                                                        \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            std::exit(1);                                                        \
+        }                                                                        \
+    } while (0)
+
+#endif // KAD_TESTS_CHECK_H
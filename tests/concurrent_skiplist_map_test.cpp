@@ -0,0 +1,115 @@
+// 8 个线程混合执行 insert / erase / find / for_each_range，
+// 结束后检查有序性和计数；节点经 epoch_retire 回收，可配合 ASan / TSan 运行
+#include "../concurrent_skiplist_map.h"
+#include "check.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    void test_single_thread()
+    {
+        kad::concurrent_skiplist_map<int, std::string> m;
+        for (int i = 100; i > 0; --i)
+        {
+            KAD_CHECK(m.insert(i, std::to_string(i)));
+        }
+        KAD_CHECK(!m.insert(5, "x"));
+
+        std::string value;
+        KAD_CHECK(m.find(5, value) && value == "5");
+        KAD_CHECK(m.erase(5));
+        KAD_CHECK(!m.erase(5));
+        KAD_CHECK(!m.contains(5));
+        KAD_CHECK(m.size() == 99);
+
+        int prev = 0;
+        int count = 0;
+        m.for_each_range(10, 20, [&](int k, const std::string &v) {
+            KAD_CHECK(k > prev && v == std::to_string(k));
+            prev = k;
+            ++count;
+        });
+        KAD_CHECK(count == 10);
+    }
+
+    void test_concurrent()
+    {
+        const int threads = 8;
+        const int ops = 20000;
+        const long key_range = 2000;
+
+        kad::concurrent_skiplist_map<long, long> m;
+        std::atomic<long> inserted(0);
+        std::atomic<long> erased(0);
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t] {
+                unsigned seed = t * 7919 + 1;
+                for (int i = 0; i < ops; ++i)
+                {
+                    seed = seed * 1103515245 + 12345;
+                    long k = (seed >> 8) % key_range;
+                    switch ((seed >> 3) % 4)
+                    {
+                    case 0:
+                        if (m.insert(k, k * 10))
+                        {
+                            ++inserted;
+                        }
+                        break;
+                    case 1:
+                        if (m.erase(k))
+                        {
+                            ++erased;
+                        }
+                        break;
+                    case 2:
+                    {
+                        long v;
+                        if (m.find(k, v))
+                        {
+                            KAD_CHECK(v == k * 10);
+                        }
+                        break;
+                    }
+                    default:
+                    {
+                        long prev = -1;
+                        m.for_each_range(k, k + 100, [&](long key, long v) {
+                            KAD_CHECK(key > prev && key >= k && key < k + 100 && v == key * 10);
+                            prev = key;
+                        });
+                        break;
+                    }
+                    }
+                }
+            });
+        }
+        for (auto &w : workers)
+        {
+            w.join();
+        }
+
+        long count = 0;
+        long prev = -1;
+        m.for_each([&](long k, long) {
+            KAD_CHECK(k > prev);
+            prev = k;
+            ++count;
+        });
+        KAD_CHECK(count == inserted - erased);
+        KAD_CHECK(static_cast<long>(m.size()) == count);
+    }
+}
+
+int main()
+{
+    test_single_thread();
+    test_concurrent();
+    return 0;
+}
@@ -0,0 +1,192 @@
+// 多个写线程并发 push_back / grow_by，同时多个读线程按 size() 扫描：
+// 读到的每个元素都必须已构造完成，最后每个写线程的元素都在且保持追加顺序。
+// 另外检查拷贝构造抛异常时只留下被跳过的槽位，不影响之后的追加
+#include "../concurrent_vector.h"
+#include "check.h"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const int writers = 4;
+    const int readers = 3;
+    const int per_writer = 20000;
+    const int batch = 8; // 每 1000 个元素插入一次 grow_by(batch)
+
+    // 元素内容：长度 24 + i % 16，字符全为 'a' + t，便于发现未构造完的对象
+    std::string make_value(int t, int i)
+    {
+        return std::string(24 + i % 16, static_cast<char>('a' + t));
+    }
+
+    bool well_formed(const std::string &s)
+    {
+        if (s.size() < 24 || s.size() >= 40 || s[0] < 'a' || s[0] >= 'a' + writers + 1)
+        {
+            return false;
+        }
+        for (char c : s)
+        {
+            if (c != s[0])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // value 为负数时拷贝构造抛异常
+    struct fragile
+    {
+        int value;
+
+        explicit fragile(int v) : value(v) {}
+
+        fragile(const fragile &other) : value(other.value)
+        {
+            if (value < 0)
+            {
+                throw std::runtime_error("fragile copy");
+            }
+        }
+    };
+}
+
+static void test_concurrent_appends()
+{
+    kad::concurrent_vector<std::string> v;
+    std::atomic<bool> done(false);
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r)
+    {
+        threads.emplace_back([&v, &done] {
+            size_t scanned = 0;
+            while (!done.load())
+            {
+                size_t n = v.size();
+                KAD_CHECK(n >= scanned);
+                for (size_t i = scanned; i < n; ++i)
+                {
+                    KAD_CHECK(well_formed(v.at(i)));
+                }
+                if (n == scanned)
+                {
+                    std::this_thread::yield();
+                }
+                scanned = n;
+            }
+        });
+    }
+
+    for (int t = 0; t < writers; ++t)
+    {
+        threads.emplace_back([&v, t] {
+            for (int i = 0; i < per_writer; ++i)
+            {
+                // 前面的追加可能还没完成，size() 不一定已包含 idx，但用 idx 访问总是安全的
+                size_t idx = v.push_back(make_value(t, i));
+                KAD_CHECK(v[idx] == make_value(t, i));
+                if (i % 1000 == 0)
+                {
+                    // grow_by 的元素用 writers 号字符标记
+                    size_t first = v.grow_by(batch, std::string(24, static_cast<char>('a' + writers)));
+                    KAD_CHECK(well_formed(v[first + batch - 1]));
+                }
+            }
+        });
+    }
+
+    for (size_t i = readers; i < threads.size(); ++i)
+    {
+        threads[i].join();
+    }
+    done.store(true);
+    for (int r = 0; r < readers; ++r)
+    {
+        threads[r].join();
+    }
+
+    const size_t grown = static_cast<size_t>(writers) * (per_writer / 1000) * batch;
+    KAD_CHECK(v.size() == static_cast<size_t>(writers) * per_writer + grown);
+
+    std::vector<int> next(writers, 0);
+    size_t filler = 0;
+    for (size_t i = 0; i < v.size(); ++i)
+    {
+        const std::string &s = v[i];
+        KAD_CHECK(well_formed(s));
+        int t = s[0] - 'a';
+        if (t == writers)
+        {
+            ++filler;
+            continue;
+        }
+        KAD_CHECK(s == make_value(t, next[t]));
+        ++next[t];
+    }
+    KAD_CHECK(filler == grown);
+    for (int t = 0; t < writers; ++t)
+    {
+        KAD_CHECK(next[t] == per_writer);
+    }
+
+    bool thrown = false;
+    try
+    {
+        v.at(v.size());
+    }
+    catch (const std::out_of_range &)
+    {
+        thrown = true;
+    }
+    KAD_CHECK(thrown);
+}
+
+static void test_failed_append()
+{
+    kad::concurrent_vector<fragile> v;
+    v.push_back(fragile(0));
+
+    bool thrown = false;
+    try
+    {
+        v.grow_by(3, fragile(-1));
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    KAD_CHECK(thrown);
+
+    // 失败的槽位被跳过，之后的追加照常发布
+    size_t i = v.push_back(fragile(7));
+    KAD_CHECK(i == 4);
+    KAD_CHECK(v.size() == 5);
+    KAD_CHECK(v.is_constructed(0) && v.is_constructed(4));
+    for (size_t j = 1; j < 4; ++j)
+    {
+        KAD_CHECK(!v.is_constructed(j));
+        bool failed = false;
+        try
+        {
+            v.at(j);
+        }
+        catch (const std::runtime_error &)
+        {
+            failed = true;
+        }
+        KAD_CHECK(failed);
+    }
+    KAD_CHECK(v.at(4).value == 7);
+}
+
+int main()
+{
+    test_concurrent_appends();
+    test_failed_append();
+    return 0;
+}
@@ -0,0 +1,164 @@
+// kad::sort / sort_by_key / parallel_sort 的结果与 std::sort 对照
+#include "../sort.h"
+#include "check.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::mt19937_64 rng(9);
+
+    template <typename T>
+    kad::vector<T> to_kad(const std::vector<T> &values)
+    {
+        kad::vector<T> v;
+        for (const T &x : values)
+        {
+            v.push_back(x);
+        }
+        return v;
+    }
+
+    // 随机字符串，前缀重复较多，便于覆盖多关键字快排的相等分支
+    std::string random_string()
+    {
+        std::string s = "k" + std::to_string(rng() % 500);
+        s += std::string(rng() % 4, 'x');
+        return s;
+    }
+
+    void test_numeric(size_t n)
+    {
+        std::vector<int64_t> a(n);
+        for (auto &x : a)
+        {
+            x = static_cast<int64_t>(rng());
+        }
+        std::vector<double> d(n);
+        for (auto &x : d)
+        {
+            x = std::uniform_real_distribution<double>(-1e6, 1e6)(rng);
+        }
+
+        kad::vector<int64_t> ka = to_kad(a);
+        kad::vector<double> kd = to_kad(d);
+        kad::sort(ka);
+        kad::sort(kd);
+        std::sort(a.begin(), a.end());
+        std::sort(d.begin(), d.end());
+        for (size_t i = 0; i < n; ++i)
+        {
+            KAD_CHECK(ka[i] == a[i]);
+            KAD_CHECK(kd[i] == d[i]);
+        }
+
+        kad::vector<int64_t> pa = to_kad(a);
+        std::shuffle(pa.data(), pa.data() + n, rng);
+        kad::parallel_sort(pa, 4);
+        for (size_t i = 0; i < n; ++i)
+        {
+            KAD_CHECK(pa[i] == a[i]);
+        }
+    }
+
+    void test_string(size_t n)
+    {
+        std::vector<std::string> ref(n);
+        kad::vector<kad::string> ks;
+        kad::vector<kad::string> ps;
+        for (size_t i = 0; i < n; ++i)
+        {
+            ref[i] = random_string();
+            ks.push_back(kad::string(ref[i].c_str()));
+            ps.push_back(kad::string(ref[i].c_str()));
+        }
+        std::sort(ref.begin(), ref.end());
+
+        kad::sort(ks);
+        kad::parallel_sort(ps, 3);
+        for (size_t i = 0; i < n; ++i)
+        {
+            KAD_CHECK(ref[i] == ks[i].c_str());
+            KAD_CHECK(ref[i] == ps[i].c_str());
+        }
+    }
+
+    // 含 NaN 的浮点数：任何规模下非 NaN 部分都有序，正的 NaN 都排在最后
+    void test_nan(size_t n)
+    {
+        kad::vector<double> v;
+        for (size_t i = 0; i < n; ++i)
+        {
+            v.push_back(i % 7 == 3 ? std::nan("") : std::uniform_real_distribution<double>(-1e3, 1e3)(rng));
+        }
+        kad::sort(v);
+        size_t nan_begin = n;
+        while (nan_begin > 0 && std::isnan(v[nan_begin - 1]))
+        {
+            --nan_begin;
+        }
+        KAD_CHECK(n - nan_begin == (n + 3) / 7);
+        for (size_t i = 1; i < nan_begin; ++i)
+        {
+            KAD_CHECK(v[i - 1] <= v[i]);
+        }
+    }
+
+    struct record
+    {
+        int id;
+        size_t order;
+        std::string name;
+    };
+
+    void test_sort_by_key(size_t n)
+    {
+        kad::vector<record> recs;
+        for (size_t i = 0; i < n; ++i)
+        {
+            recs.push_back({static_cast<int>(rng() % 50), i, std::to_string(rng() % 20)});
+        }
+        kad::sort_by_key(recs, [](const record &r) { return r.id; });
+        for (size_t i = 1; i < n; ++i)
+        {
+            KAD_CHECK(recs[i - 1].id <= recs[i].id);
+            if (recs[i - 1].id == recs[i].id)
+            {
+                KAD_CHECK(recs[i - 1].order < recs[i].order); // 稳定
+            }
+        }
+
+        // 非数值键走比较排序，同样必须稳定
+        for (size_t i = 0; i < n; ++i)
+        {
+            recs[i].order = i;
+        }
+        kad::sort_by_key(recs, [](const record &r) { return r.name; });
+        for (size_t i = 1; i < n; ++i)
+        {
+            KAD_CHECK(!(recs[i].name < recs[i - 1].name));
+            if (recs[i - 1].name == recs[i].name)
+            {
+                KAD_CHECK(recs[i - 1].order < recs[i].order);
+            }
+        }
+    }
+}
+
+int main()
+{
+    const size_t sizes[] = {0, 1, 5, 23, 24, 30, 100, 255, 256, 1000, 5000, 100000};
+    for (size_t n : sizes)
+    {
+        test_numeric(n);
+        test_string(n);
+        test_sort_by_key(n);
+        test_nan(n);
+    }
+    return 0;
+}
@@ -0,0 +1,292 @@
+#ifndef THREAD_CACHE_H
+#define THREAD_CACHE_H
+
+#include <cstddef> // for size_t, ptrdiff_t
+#include <mutex>
+#include <new>     // for std::bad_alloc, ::operator new, ::operator delete
+
+namespace kad
+{
+    // 线程缓存分配器：小块内存按大小分级，每个线程有自己的空闲链表，
+    // 链表空了从中心池批量取，攒多了批量还给中心池，只有这两步需要加锁。
+    // 块之间没有归属关系，所以一个线程释放另一个线程分配的块也是安全的。
+    // 中心池向系统申请的大块内存不会归还。
+    namespace thread_cache_detail
+    {
+        static const size_t num_classes = 8;          // 16, 32, ..., 2048 字节
+        static const size_t min_block = 16;
+        static const size_t max_block = min_block << (num_classes - 1);
+        static const size_t batch_size = 32;          // 每次与中心池交换的块数
+        static const size_t chunk_bytes = 64 * 1024;  // 中心池每次向系统申请的大小
+
+        struct free_block
+        {
+            free_block *next;
+        };
+
+        inline size_t size_class(size_t bytes)
+        {
+            size_t c = 0;
+            size_t block = min_block;
+            while (block < bytes)
+            {
+                block <<= 1;
+                ++c;
+            }
+            return c;
+        }
+
+        inline size_t class_size(size_t c)
+        {
+            return min_block << c;
+        }
+
+        // 所有线程共享的中心池，每个大小级别一把锁
+        class central_pool
+        {
+        private:
+            struct bucket
+            {
+                std::mutex mutex;
+                free_block *head = nullptr;
+            };
+
+            bucket buckets[num_classes];
+
+            // 切一块新的内存，串成链表
+            static free_block *carve(size_t c, size_t &count)
+            {
+                size_t size = class_size(c);
+                count = chunk_bytes / size;
+                char *chunk = static_cast<char *>(::operator new(chunk_bytes));
+                for (size_t i = 0; i + 1 < count; ++i)
+                {
+                    reinterpret_cast<free_block *>(chunk + i * size)->next =
+                        reinterpret_cast<free_block *>(chunk + (i + 1) * size);
+                }
+                reinterpret_cast<free_block *>(chunk + (count - 1) * size)->next = nullptr;
+                return reinterpret_cast<free_block *>(chunk);
+            }
+
+        public:
+            // 取出至多 batch_size 个块，返回链表头，count 为实际个数
+            free_block *fetch(size_t c, size_t &count)
+            {
+                bucket &b = buckets[c];
+                {
+                    std::lock_guard<std::mutex> lock(b.mutex);
+                    if (b.head)
+                    {
+                        free_block *first = b.head;
+                        free_block *last = first;
+                        count = 1;
+                        while (count < batch_size && last->next)
+                        {
+                            last = last->next;
+                            ++count;
+                        }
+                        b.head = last->next;
+                        last->next = nullptr;
+                        return first;
+                    }
+                }
+                return carve(c, count);
+            }
+
+            // 归还一串以 last 结尾的块
+            void release(size_t c, free_block *first, free_block *last)
+            {
+                bucket &b = buckets[c];
+                std::lock_guard<std::mutex> lock(b.mutex);
+                last->next = b.head;
+                b.head = first;
+            }
+        };
+
+        // 中心池故意不析构，保证其它静态对象析构时仍可释放内存
+        inline central_pool &central()
+        {
+            static central_pool *pool = new central_pool();
+            return *pool;
+        }
+
+        class thread_cache
+        {
+        private:
+            free_block *heads[num_classes] = {};
+            size_t counts[num_classes] = {};
+
+            // 从链表头部取下 n 个块还给中心池
+            void release_batch(size_t c, size_t n)
+            {
+                free_block *first = heads[c];
+                free_block *last = first;
+                for (size_t i = 1; i < n; ++i)
+                {
+                    last = last->next;
+                }
+                heads[c] = last->next;
+                counts[c] -= n;
+                central().release(c, first, last);
+            }
+
+        public:
+            ~thread_cache()
+            {
+                for (size_t c = 0; c < num_classes; ++c)
+                {
+                    if (counts[c])
+                    {
+                        release_batch(c, counts[c]);
+                    }
+                }
+            }
+
+            void *allocate(size_t c)
+            {
+                if (!heads[c])
+                {
+                    heads[c] = central().fetch(c, counts[c]);
+                }
+                free_block *block = heads[c];
+                heads[c] = block->next;
+                --counts[c];
+                return block;
+            }
+
+            void deallocate(void *p, size_t c)
+            {
+                free_block *block = static_cast<free_block *>(p);
+                block->next = heads[c];
+                heads[c] = block;
+                if (++counts[c] >= batch_size * 2)
+                {
+                    release_batch(c, batch_size);
+                }
+            }
+        };
+
+        // 线程退出时缓存已析构，之后的分配/释放直接走中心池
+        inline bool &cache_destroyed()
+        {
+            static thread_local bool destroyed = false;
+            return destroyed;
+        }
+
+        struct cache_holder
+        {
+            thread_cache cache;
+            ~cache_holder() { cache_destroyed() = true; }
+        };
+
+        inline thread_cache *local_cache()
+        {
+            if (cache_destroyed())
+            {
+                return nullptr;
+            }
+            static thread_local cache_holder holder;
+            return &holder.cache;
+        }
+    }
+
+    // 分配 bytes 字节；超过最大级别的请求直接交给 ::operator new
+    inline void *thread_cache_allocate(size_t bytes)
+    {
+        using namespace thread_cache_detail;
+        if (bytes > max_block)
+        {
+            return ::operator new(bytes);
+        }
+        size_t c = size_class(bytes);
+        thread_cache *cache = local_cache();
+        if (cache)
+        {
+            return cache->allocate(c);
+        }
+        size_t count;
+        free_block *first = central().fetch(c, count);
+        if (first->next)
+        {
+            free_block *last = first->next;
+            while (last->next)
+            {
+                last = last->next;
+            }
+            central().release(c, first->next, last);
+        }
+        return first;
+    }
+
+    // bytes 必须与分配时相同
+    inline void thread_cache_deallocate(void *p, size_t bytes)
+    {
+        using namespace thread_cache_detail;
+        if (!p)
+        {
+            return;
+        }
+        if (bytes > max_block)
+        {
+            ::operator delete(p, bytes);
+            return;
+        }
+        size_t c = size_class(bytes);
+        thread_cache *cache = local_cache();
+        if (cache)
+        {
+            cache->deallocate(p, c);
+            return;
+        }
+        free_block *block = static_cast<free_block *>(p);
+        central().release(c, block, block);
+    }
+
+    // 与 kad::allocator 接口相同，可直接作为各容器的 alloc 参数
+    template <typename T>
+    class thread_cache_allocator
+    {
+    public:
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+        using value_type = T;
+
+        thread_cache_allocator() = default;
+        ~thread_cache_allocator() = default;
+
+        // 分配内存
+        T* allocate(size_type n)
+        {
+            if (n > static_cast<size_type>(-1) / sizeof(T))
+            {
+                throw std::bad_alloc(); // 如果请求的内存大小太大，则抛出异常
+            }
+            return static_cast<T*>(thread_cache_allocate(n * sizeof(T)));
+        }
+
+        // 释放内存
+        void deallocate(T* p, size_type n)
+        {
+            thread_cache_deallocate(p, n * sizeof(T));
+        }
+
+        // 在已分配内存上构造对象
+        void construct(T* p, const T& value)
+        {
+            new(p) T(value);
+        }
+
+        void construct(T* p, T&& value)
+        {
+            new(p) T(static_cast<T&&>(value));
+        }
+
+        // 销毁对象
+        void destroy(T* p)
+        {
+            p->~T();
+        }
+    };
+}
+
+#endif // THREAD_CACHE_H
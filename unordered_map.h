@@ -2,14 +2,64 @@
 #define UNORDERED_MAP
 
 
+#include <functional>
+#include <atomic>
 #include <iostream>
 #include <list>
 #include <vector>
 #include <stdexcept>
+#include <utility>
+#include "bloom_filter.h"
+#include "config.h"
+#include "parallel.h"
 
 namespace kad {
 
-template <typename KeyType, typename ValueType>
+// 过滤器统计：被过滤器直接拒绝的查询数，以及通过过滤器但实际不存在的查询数
+struct filter_stats {
+    size_t lookups = 0;
+    size_t rejected = 0;
+    size_t false_positives = 0;
+    double estimated_false_positive_rate = 0.0;
+
+    // 实测假阳性率：不存在的键中有多少没被过滤器拦住
+    double false_positive_rate() const {
+        size_t negatives = rejected + false_positives;
+        return negatives ? static_cast<double>(false_positives) / negatives : 0.0;
+    }
+};
+
+// 过滤器统计的计数器。const 查找也会计数，用 relaxed 原子操作，
+// 多个线程同时做只读查找不构成数据竞争；拷贝时复制当前值
+struct filter_counters {
+    std::atomic<size_t> lookups;
+    std::atomic<size_t> rejected;
+    std::atomic<size_t> false_positives;
+
+    filter_counters() : lookups(0), rejected(0), false_positives(0) {}
+
+    filter_counters(const filter_counters& other)
+        : lookups(other.lookups.load(std::memory_order_relaxed)),
+          rejected(other.rejected.load(std::memory_order_relaxed)),
+          false_positives(other.false_positives.load(std::memory_order_relaxed)) {}
+
+    filter_counters& operator=(const filter_counters& other) {
+        lookups.store(other.lookups.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        rejected.store(other.rejected.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        false_positives.store(other.false_positives.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    void reset() {
+        lookups.store(0, std::memory_order_relaxed);
+        rejected.store(0, std::memory_order_relaxed);
+        false_positives.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Hash 计算键的哈希值，KeyEqual 判断两个键是否相等
+template <typename KeyType, typename ValueType,
+          typename Hash = std::hash<KeyType>, typename KeyEqual = std::equal_to<KeyType>>
 class unordered_map {
 private:
     // 每个桶是一个链表，用于存储哈希冲突的元素
@@ -17,23 +67,101 @@ private:
     size_t num_elements;
     float load_factor_threshold; // 负载因子阈值
     size_t capacity; // 当前桶的数量
+    bloom_filter filter; // 可选的近似成员过滤器，用于快速拒绝不存在的键
+    mutable filter_counters stats_;
+    Hash hasher;
+    KeyEqual key_equal;
+
+    // 完整哈希值，过滤器和桶下标共用
+    size_t full_hash(const KeyType& key) const {
+        // 默认使用 std::hash
+        return hasher(key);
+    }
 
     // 哈希函数
     size_t hash(const KeyType& key) const {
-        // 使用 std::hash 作为默认哈希函数
-        return std::hash<KeyType>{}(key) % capacity;
+        return full_hash(key) % capacity;
+    }
+
+    // 过滤器判定一定不存在时返回 true
+    bool filtered_out(size_t h) const {
+        if (!filter.enabled()) {
+            return false;
+        }
+        stats_.lookups.fetch_add(1, std::memory_order_relaxed);
+        if (!filter.may_contain(h)) {
+            stats_.rejected.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
     }
 
-    // 如果负载因子过大，进行扩容
+    // 通过过滤器却没找到，计一次假阳性
+    void record_miss() const {
+        if (filter.enabled()) {
+            stats_.false_positives.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // 批量查找时每组同时在途的键数
+    static const size_t batch_group = 16;
+
+    // 分组流水线查找：先算出整组键的哈希并预取桶和过滤器块，再预取各桶首节点，
+    // 最后逐个比较，使一组内的缓存缺失互相重叠。found(i, value) 处理结果
+    template <typename Found>
+    void lookup_batch(const KeyType* keys, size_t n, Found found) const {
+        size_t hashes[batch_group];
+        bool skip[batch_group];
+
+        for (size_t base = 0; base < n; base += batch_group) {
+            size_t m = n - base < batch_group ? n - base : batch_group;
+
+            // 阶段一：计算哈希，预取桶和过滤器块
+            for (size_t i = 0; i < m; ++i) {
+                hashes[i] = full_hash(keys[base + i]);
+                KAD_PREFETCH(&table[hashes[i] % capacity]);
+                filter.prefetch(hashes[i]);
+            }
+
+            // 阶段二：过滤器拒绝，否则预取桶内第一个节点
+            for (size_t i = 0; i < m; ++i) {
+                skip[i] = filtered_out(hashes[i]);
+                const auto& bucket = table[hashes[i] % capacity];
+                if (!skip[i] && !bucket.empty()) {
+                    KAD_PREFETCH(&bucket.front());
+                }
+            }
+
+            // 阶段三：在桶内比较键
+            for (size_t i = 0; i < m; ++i) {
+                const ValueType* value = nullptr;
+                if (!skip[i]) {
+                    for (const auto& pair : table[hashes[i] % capacity]) {
+                        if (key_equal(pair.first, keys[base + i])) {
+                            value = &pair.second;
+                            break;
+                        }
+                    }
+                    if (!value) {
+                        record_miss();
+                    }
+                }
+                found(base + i, value);
+            }
+        }
+    }
+
+    // 如果负载因子过大，进行扩容。始终在当前线程完成，多线程扩容需显式调用 rehash_parallel
     void rehash() {
         size_t new_capacity = capacity * 2;
         std::vector<std::list<std::pair<KeyType, ValueType>>> new_table(new_capacity);
 
-        // 迁移元素到新的哈希表
+        // 迁移元素到新的哈希表，直接移动链表节点，不重新分配
         for (size_t i = 0; i < capacity; ++i) {
-            for (auto& pair : table[i]) {
-                size_t new_index = std::hash<KeyType>{}(pair.first) % new_capacity;
-                new_table[new_index].push_back(std::move(pair));
+            auto& bucket = table[i];
+            while (!bucket.empty()) {
+                size_t new_index = full_hash(bucket.front().first) % new_capacity;
+                new_table[new_index].splice(new_table[new_index].end(), bucket, bucket.begin());
             }
         }
 
@@ -42,9 +170,17 @@ private:
         capacity = new_capacity;
     }
 
+    // 每个线程暂存的、发往某个目标分区的元素
+    struct staging_area {
+        std::list<std::pair<KeyType, ValueType>> nodes;
+        std::vector<size_t> indices; // 与 nodes 一一对应的新桶下标
+    };
+
 public:
-    unordered_map(size_t initial_capacity = 16, float load_factor = 0.75)
-        : capacity(initial_capacity), num_elements(0), load_factor_threshold(load_factor) {
+    unordered_map(size_t initial_capacity = 16, float load_factor = 0.75,
+                  const Hash& hash_fn = Hash(), const KeyEqual& equal = KeyEqual())
+        : num_elements(0), load_factor_threshold(load_factor), capacity(initial_capacity),
+          hasher(hash_fn), key_equal(equal) {
         table.resize(capacity);
     }
 
@@ -54,12 +190,12 @@ public:
             rehash(); // 如果负载因子超过阈值，则扩容
         }
 
-        size_t index = hash(key);
-        auto& bucket = table[index];
+        size_t h = full_hash(key);
+        auto& bucket = table[h % capacity];
 
         // 检查是否已存在该键，若存在则更新值
         for (auto& pair : bucket) {
-            if (pair.first == key) {
+            if (key_equal(pair.first, key)) {
                 pair.second = value;
                 return;
             }
@@ -68,17 +204,16 @@ public:
         // 如果键不存在，则插入新元素
         bucket.push_back({key, value});
         ++num_elements;
+        if (filter.enabled()) {
+            filter.insert(h);
+        }
     }
 
     // 查找元素
     ValueType& at(const KeyType& key) {
-        size_t index = hash(key);
-        auto& bucket = table[index];
-
-        for (auto& pair : bucket) {
-            if (pair.first == key) {
-                return pair.second; // 返回对应的值
-            }
+        ValueType* value = find(key);
+        if (value) {
+            return *value;
         }
 
         throw std::out_of_range("Key not found in unordered_map");
@@ -86,32 +221,256 @@ public:
 
     // 查找元素（const 版本）
     const ValueType& at(const KeyType& key) const {
-        size_t index = hash(key);
-        const auto& bucket = table[index];
+        size_t h = full_hash(key);
+        if (!filtered_out(h)) {
+            const auto& bucket = table[h % capacity];
 
-        for (const auto& pair : bucket) {
-            if (pair.first == key) {
-                return pair.second; // 返回对应的值
+            for (const auto& pair : bucket) {
+                if (key_equal(pair.first, key)) {
+                    return pair.second; // 返回对应的值
+                }
             }
+            record_miss();
         }
 
         throw std::out_of_range("Key not found in unordered_map");
     }
 
+    // 查找元素，未找到返回 nullptr
+    ValueType* find(const KeyType& key) {
+        size_t h = full_hash(key);
+        if (filtered_out(h)) {
+            return nullptr;
+        }
+        auto& bucket = table[h % capacity];
+
+        for (auto& pair : bucket) {
+            if (key_equal(pair.first, key)) {
+                return &pair.second;
+            }
+        }
+
+        record_miss();
+        return nullptr;
+    }
+
+    // 删除元素，返回是否删除成功
+    bool erase(const KeyType& key) {
+        size_t h = full_hash(key);
+        auto& bucket = table[h % capacity];
+
+        for (auto it = bucket.begin(); it != bucket.end(); ++it) {
+            if (key_equal(it->first, key)) {
+                bucket.erase(it);
+                --num_elements;
+                if (filter.enabled()) {
+                    filter.erase(h);
+                }
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     // 判断某个键是否存在
     bool contains(const KeyType& key) const {
-        size_t index = hash(key);
-        const auto& bucket = table[index];
+        size_t h = full_hash(key);
+        if (filtered_out(h)) {
+            return false;
+        }
+        const auto& bucket = table[h % capacity];
 
         for (const auto& pair : bucket) {
-            if (pair.first == key) {
+            if (key_equal(pair.first, key)) {
                 return true;
             }
         }
 
+        record_miss();
         return false;
     }
 
+    // 批量查找 n 个键，out[i] 为 keys[i] 对应的值，未找到为 nullptr
+    void find_batch(const KeyType* keys, size_t n, ValueType** out) {
+        lookup_batch(keys, n, [out](size_t i, const ValueType* value) {
+            out[i] = const_cast<ValueType*>(value);
+        });
+    }
+
+    void find_batch(const KeyType* keys, size_t n, const ValueType** out) const {
+        lookup_batch(keys, n, [out](size_t i, const ValueType* value) {
+            out[i] = value;
+        });
+    }
+
+    // 批量判断 n 个键是否存在
+    void contains_batch(const KeyType* keys, size_t n, bool* out) const {
+        lookup_batch(keys, n, [out](size_t i, const ValueType* value) {
+            out[i] = value != nullptr;
+        });
+    }
+
+    // 启用近似成员过滤器，按预期元素数确定大小，并把已有元素加入过滤器
+    void enable_filter(size_t expected_elements) {
+        filter.reset(expected_elements > num_elements ? expected_elements : num_elements);
+        for (size_t i = 0; i < capacity; ++i) {
+            for (const auto& pair : table[i]) {
+                filter.insert(full_hash(pair.first));
+            }
+        }
+        stats_.reset();
+    }
+
+    void disable_filter() {
+        filter.clear();
+    }
+
+    // 过滤器统计，估算假阳性率按当前计数器填充度计算
+    filter_stats stats() const {
+        filter_stats result;
+        result.lookups = stats_.lookups.load(std::memory_order_relaxed);
+        result.rejected = stats_.rejected.load(std::memory_order_relaxed);
+        result.false_positives = stats_.false_positives.load(std::memory_order_relaxed);
+        result.estimated_false_positive_rate =
+            filter.enabled() ? filter.estimated_false_positive_rate() : 0.0;
+        return result;
+    }
+
+    // 多线程扩容到 new_capacity 个桶：
+    // 第一步每个线程负责一段旧桶，算出新下标后把节点按目标分区移到自己的暂存区；
+    // 第二步每个线程负责一段新桶，从所有线程的暂存区取出属于自己的节点挂入新桶。
+    // 两步中每个链表都只被一个线程修改，不需要加锁，也不重新分配节点。
+    // 每次调用都会创建 threads - 1 个线程，只适合一次性的大规模扩容，insert() 不会调用它。
+    // 第一步抛异常时节点被放回旧桶，表保持调用前的状态
+    void rehash_parallel(size_t new_capacity, size_t threads = 0) {
+        if (threads == 0) {
+            threads = parallel_detail::default_threads();
+        }
+        if (new_capacity == 0) {
+            new_capacity = 1;
+        }
+        std::vector<std::list<std::pair<KeyType, ValueType>>> new_table(new_capacity);
+        std::vector<std::vector<staging_area>> staging(threads, std::vector<staging_area>(threads));
+        size_t old_capacity = capacity;
+
+        try {
+            parallel_detail::run_parallel(threads, [&](size_t t) {
+                size_t begin = old_capacity * t / threads;
+                size_t end = old_capacity * (t + 1) / threads;
+                for (size_t i = begin; i < end; ++i) {
+                    auto& bucket = table[i];
+                    while (!bucket.empty()) {
+                        size_t index = full_hash(bucket.front().first) % new_capacity;
+                        staging_area& area = staging[t][index * threads / new_capacity];
+                        area.indices.push_back(index); // 可能抛异常，先于 splice 执行
+                        area.nodes.splice(area.nodes.end(), bucket, bucket.begin());
+                    }
+                }
+            });
+        } catch (...) {
+            for (auto& row : staging) {
+                for (auto& area : row) {
+                    while (!area.nodes.empty()) {
+                        auto& bucket = table[full_hash(area.nodes.front().first) % old_capacity];
+                        bucket.splice(bucket.end(), area.nodes, area.nodes.begin());
+                    }
+                }
+            }
+            throw;
+        }
+
+        // 第二步只做 splice，不会抛异常
+        parallel_detail::run_parallel(threads, [&](size_t p) {
+            for (size_t t = 0; t < threads; ++t) {
+                staging_area& area = staging[t][p];
+                for (size_t index : area.indices) {
+                    new_table[index].splice(new_table[index].end(), area.nodes, area.nodes.begin());
+                }
+            }
+        });
+
+        table = std::move(new_table);
+        capacity = new_capacity;
+    }
+
+    // 多线程批量插入，已存在的键更新为最后出现的值。
+    // 先按负载因子一次扩容到位，再像 rehash_parallel 一样按目标分区分发给各线程插入。
+    // 中途抛异常时已插入的元素保留并计入 size()
+    void bulk_insert(const std::pair<KeyType, ValueType>* items, size_t n, size_t threads = 0) {
+        if (threads == 0) {
+            threads = parallel_detail::default_threads();
+        }
+        size_t needed = static_cast<size_t>((num_elements + n) / load_factor_threshold) + 1;
+        if (needed > capacity) {
+            size_t new_capacity = capacity;
+            while (new_capacity < needed) {
+                new_capacity *= 2;
+            }
+            rehash_parallel(new_capacity, threads);
+        }
+
+        // (完整哈希值, 输入下标)；每个键只在第一步哈希一次
+        std::vector<std::vector<std::vector<std::pair<size_t, size_t>>>> staging(
+            threads, std::vector<std::vector<std::pair<size_t, size_t>>>(threads));
+        std::vector<std::vector<size_t>> added(threads); // 各线程新插入元素的哈希值
+
+        parallel_detail::run_parallel(threads, [&](size_t t) {
+            size_t begin = n * t / threads;
+            size_t end = n * (t + 1) / threads;
+            for (size_t i = begin; i < end; ++i) {
+                size_t h = full_hash(items[i].first);
+                staging[t][(h % capacity) * threads / capacity].push_back({h, i});
+            }
+        });
+
+        auto account = [&] {
+            for (const auto& hashes : added) {
+                num_elements += hashes.size();
+                if (filter.enabled()) {
+                    for (size_t h : hashes) {
+                        filter.insert(h);
+                    }
+                }
+            }
+        };
+
+        try {
+            parallel_detail::run_parallel(threads, [&](size_t p) {
+                // 先预留，插入后记录哈希值时不会再抛异常
+                size_t incoming = 0;
+                for (size_t t = 0; t < threads; ++t) {
+                    incoming += staging[t][p].size();
+                }
+                added[p].reserve(incoming);
+
+                // 按 t 的顺序处理，保持输入中的先后关系
+                for (size_t t = 0; t < threads; ++t) {
+                    for (const auto& entry : staging[t][p]) {
+                        const auto& item = items[entry.second];
+                        auto& bucket = table[entry.first % capacity];
+                        bool found = false;
+                        for (auto& pair : bucket) {
+                            if (key_equal(pair.first, item.first)) {
+                                pair.second = item.second;
+                                found = true;
+                                break;
+                            }
+                        }
+                        if (!found) {
+                            bucket.push_back(item);
+                            added[p].push_back(entry.first);
+                        }
+                    }
+                }
+            });
+        } catch (...) {
+            account();
+            throw;
+        }
+        account();
+    }
+
     // 返回元素数量
     size_t size() const {
         return num_elements;
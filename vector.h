@@ -2,6 +2,7 @@
 #define VECTOR_H
 
 #include "allocator.h"
+#include "config.h"
 #include "iterator.h"
 #include <stdexcept>
 namespace kad
@@ -24,10 +25,14 @@ namespace kad
         size_type capacity_;
         alloc allocator_;
 
+        // 把元素搬到容量为 new_capacity 的新内存。append 非空时先在新内存末尾构造它，
+        // 再搬迁旧元素，所以 append 可以指向本容器内的元素（如 v.push_back(v[0])）
+        void reallocate(size_type new_capacity, const val_type *append = nullptr);
+
     public:
         vector(/* args */);
         vector(size_type n);
-        vector(vector &vec);
+        vector(const vector &vec);
         vector(vector &&vec);
         vector(size_type n, T val);
         ~vector();
@@ -38,7 +43,12 @@ namespace kad
         // 返回指向Vector末尾元素之后位置的迭代器（尾后迭代器）
         iterator<T> end();
         void push_back(const val_type &value);
+        // 预留至少 n 个元素的空间
+        void reserve(size_type n);
+        // 销毁所有元素，保留已分配的内存
+        void clear();
         size_t size() const;
+        size_t capacity() const;
         bool empty() const;
         value_type *data() const;
 
@@ -49,15 +59,42 @@ namespace kad
 
         T &operator[](size_t i)
         {
+            KAD_CHECK_BOUNDS(i < size_, "vector::operator[]: index out of range");
             return *(data_ + i);
         }
-        T &operator=(vector &vec)
+        vector &operator=(const vector &vec)
         {
-            if(vec.data_==data){
+            if (this == &vec)
+            {
                 return *this;
             }
 
-            vector<>
+            vector tmp(vec);
+            swap(tmp);
+            return *this;
+        }
+
+        vector &operator=(vector &&vec)
+        {
+            if (this != &vec)
+            {
+                vector tmp(static_cast<vector &&>(vec));
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        void swap(vector &vec)
+        {
+            value_type *d = data_;
+            data_ = vec.data_;
+            vec.data_ = d;
+            size_type s = size_;
+            size_ = vec.size_;
+            vec.size_ = s;
+            size_type c = capacity_;
+            capacity_ = vec.capacity_;
+            vec.capacity_ = c;
         }
     };
 
@@ -77,9 +114,30 @@ namespace kad
     vector<T, alloc>::vector()
         : data_(nullptr), size_(0), capacity_(0), allocator_()
     {
-        // 初始分配一些空间（例如，4个元素的空间）
-        capacity_ = 4;
-        data_ = allocator_.allocate(capacity_);
+        // 空 vector 不分配内存，第一次 push_back 时再分配
+    }
+
+    template <typename T, typename alloc>
+    vector<T, alloc>::vector(const vector &vec)
+        : data_(nullptr), size_(vec.size_), capacity_(vec.size_), allocator_()
+    {
+        if (capacity_)
+        {
+            data_ = allocator_.allocate(capacity_);
+        }
+        for (size_t i = 0; i < size_; ++i)
+        {
+            allocator_.construct(data_ + i, vec.data_[i]);
+        }
+    }
+
+    template <typename T, typename alloc>
+    vector<T, alloc>::vector(vector &&vec)
+        : data_(vec.data_), size_(vec.size_), capacity_(vec.capacity_), allocator_()
+    {
+        vec.data_ = nullptr;
+        vec.size_ = 0;
+        vec.capacity_ = 0;
     }
     template <typename T, typename alloc>
     vector<T, alloc>::vector(size_type n)
@@ -87,6 +145,10 @@ namespace kad
     {
         // 初始分配一些空间n
         data_ = allocator_.allocate(capacity_);
+        for (size_t i = 0; i < n; i++)
+        {
+            allocator_.construct(data_ + i, T());
+        }
     }
 
     template <typename T, typename alloc>
@@ -95,53 +157,107 @@ namespace kad
     {
         // 初始分配一些空间n
         data_ = allocator_.allocate(capacity_);
-        for (int i = 0; i < n; i++)
+        for (size_t i = 0; i < n; i++)
         {
-            data_[i] = val;
+            allocator_.construct(data_ + i, val);
         }
     }
 
     template <typename T, typename alloc>
     vector<T, alloc>::~vector()
     {
-        // 释放已分配的内存
-        allocator_.deallocate(data_, capacity_);
+        // 销毁元素并释放已分配的内存
+        clear();
+        if (data_)
+        {
+            allocator_.deallocate(data_, capacity_);
+        }
     }
 
     template <typename T, typename alloc>
-    void vector<T, alloc>::push_back(const val_type &value)
+    void vector<T, alloc>::reallocate(size_type new_capacity, const val_type *append)
     {
-        if (size_ == capacity_)
-        {
-            // 如果当前大小等于容量，增加容量（例如，翻倍）
-            size_t new_capacity = capacity_ * 2;
-            val_type *new_data = allocator_.allocate(new_capacity);
+        val_type *new_data = allocator_.allocate(new_capacity);
 
-            // 复制旧数据到新数据区域
-            for (size_t i = 0; i < size_; ++i)
+        if (append)
+        {
+            try
+            {
+                allocator_.construct(new_data + size_, *append);
+            }
+            catch (...)
             {
-                new_data[i] = data_[i];
+                allocator_.deallocate(new_data, new_capacity);
+                throw;
             }
+        }
 
-            // 释放旧数据区域
-            allocator_.deallocate(data_, capacity_);
+        // 把旧数据移动到新数据区域
+        for (size_t i = 0; i < size_; ++i)
+        {
+            allocator_.construct(new_data + i, static_cast<val_type &&>(data_[i]));
+            allocator_.destroy(data_ + i);
+        }
 
-            // 更新数据指针和容量
-            data_ = new_data;
-            capacity_ = new_capacity;
+        // 释放旧数据区域
+        if (data_)
+        {
+            allocator_.deallocate(data_, capacity_);
         }
 
-        // 在末尾添加新元素
-        data_[size_] = value;
+        // 更新数据指针和容量
+        data_ = new_data;
+        capacity_ = new_capacity;
+    }
+
+    template <typename T, typename alloc>
+    void vector<T, alloc>::push_back(const val_type &value)
+    {
+        if (size_ == capacity_)
+        {
+            // 如果当前大小等于容量，增加容量（例如，翻倍）；空 vector 首次分配 4 个元素。
+            // 新元素在旧元素销毁之前构造，value 可能引用旧元素
+            reallocate(capacity_ ? capacity_ * 2 : 4, &value);
+        }
+        else
+        {
+            // 在末尾构造新元素
+            allocator_.construct(data_ + size_, value);
+        }
         ++size_;
     }
 
+    template <typename T, typename alloc>
+    void vector<T, alloc>::reserve(size_type n)
+    {
+        if (n > capacity_)
+        {
+            reallocate(n);
+        }
+    }
+
+    template <typename T, typename alloc>
+    void vector<T, alloc>::clear()
+    {
+        for (size_t i = 0; i < size_; ++i)
+        {
+            allocator_.destroy(data_ + i);
+        }
+        size_ = 0;
+    }
+
     template <typename T, typename alloc>
     size_t vector<T, alloc>::size() const
     {
         return size_;
     }
 
+    template <typename T, typename alloc>
+    size_t vector<T, alloc>::capacity() const
+    {
+        return capacity_;
+    }
+
     template <typename T, typename alloc>
     bool vector<T, alloc>::empty() const
     {
@@ -158,9 +274,7 @@ namespace kad
     template <typename T, typename alloc>
     T& vector<T, alloc>::front() 
     {
-        if (size_ == 0) {
-            throw std::out_of_range("vector::back(): empty vector");
-        }
+        KAD_CHECK_BOUNDS(size_ != 0, "vector::front(): empty vector");
 
         return data_[0];
     }
@@ -168,9 +282,7 @@ namespace kad
         template <typename T, typename alloc>
     T& vector<T, alloc>::back() 
     {
-        if (size_ == 0) {
-            throw std::out_of_range("vector::back(): empty vector");
-        }
+        KAD_CHECK_BOUNDS(size_ != 0, "vector::back(): empty vector");
 
         return data_[size_-1];
     }